@@ -0,0 +1,325 @@
+/* simple scope -- headless robtk stand-in for the benchmark
+ *
+ * Copyright (C) 2013 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Provides the subset of the robtk API used by gui/sisco.c.
+ * Widgets only hold their value and invoke callbacks on change,
+ * nothing is shown. Drawing uses a plain cairo image surface.
+ */
+
+#ifndef SCO_ROBTK_HEADLESS_H
+#define SCO_ROBTK_HEADLESS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include <cairo/cairo.h>
+#include <pango/pangocairo.h>
+
+#ifndef TRUE
+#define TRUE  (1)
+#define FALSE (0)
+#endif
+
+typedef struct {
+  int x, y;
+  int state;
+  int direction;
+  int button;
+} RobTkBtnEvent;
+
+enum {
+  ROBTK_SCROLL_ZERO,
+  ROBTK_SCROLL_UP,
+  ROBTK_SCROLL_DOWN,
+  ROBTK_SCROLL_LEFT,
+  ROBTK_SCROLL_RIGHT
+};
+
+#define ROBTK_MOD_SHIFT (1)
+#define ROBTK_MOD_CTRL  (2)
+
+typedef struct _RobWidget {
+  void* self;
+  void* top;
+  bool hidden;
+  int area_w, area_h;
+  bool (*expose_event) (struct _RobWidget*, cairo_t*, cairo_rectangle_t*);
+  void (*size_request) (struct _RobWidget*, int*, int*);
+  void (*size_allocate) (struct _RobWidget*, int, int);
+  struct _RobWidget* (*mousedown) (struct _RobWidget*, RobTkBtnEvent*);
+  struct _RobWidget* (*mouseup) (struct _RobWidget*, RobTkBtnEvent*);
+  struct _RobWidget* (*mousemove) (struct _RobWidget*, RobTkBtnEvent*);
+  struct _RobWidget* (*mousescroll) (struct _RobWidget*, RobTkBtnEvent*);
+} RobWidget;
+
+#define GET_HANDLE(RW) (((RobWidget*)(RW))->self)
+#define ROBWIDGET_SETNAME(RW, NAME)
+
+#define RTK_EXANDF (3)
+#define RTK_SHRINK (4)
+#define GBT_LED_LEFT (1)
+#define GSP_WIDTH  (25)
+#define GSP_HEIGHT (30)
+#define GSP_CX     (12.5)
+#define GSP_CY     (12.5)
+#define GSP_RADIUS (10)
+#define GED_HEIGHT (30)
+#define GED_CY     (14)
+#define GED_RADIUS (11)
+
+#define CairoSetSouerceRGBA(COL) \
+  cairo_set_source_rgba (cr, (COL)[0], (COL)[1], (COL)[2], (COL)[3])
+
+static const float c_wht[4] = {1.0, 1.0, 1.0, 1.0};
+static const float c_g30[4] = {0.3, 0.3, 0.3, 1.0};
+
+enum LVGLResize {
+  LVGL_ZOOM_TO_ASPECT,
+  LVGL_LAYOUT_TO_FIT,
+  LVGL_CENTER,
+  LVGL_TOP_LEFT
+};
+
+/* redraw requests are counted, the benchmark renders at a fixed rate */
+static uint64_t headless_queue_draw_cnt = 0;
+
+static inline void queue_draw (RobWidget* rw) { ++headless_queue_draw_cnt; }
+static inline void queue_draw_area (RobWidget* rw, int x, int y, int w, int h) { ++headless_queue_draw_cnt; }
+
+/* widget containers */
+
+static inline RobWidget* robwidget_new (void* handle) {
+  RobWidget* rw = (RobWidget*) calloc (1, sizeof (RobWidget));
+  rw->self = handle;
+  return rw;
+}
+
+static inline void robwidget_destroy (RobWidget* rw) { free (rw); }
+static inline void robwidget_make_toplevel (RobWidget* rw, void* top) { rw->top = top; }
+static inline void robwidget_set_alignment (RobWidget* rw, float x, float y) {}
+static inline void robwidget_set_expose_event (RobWidget* rw, bool (*f) (RobWidget*, cairo_t*, cairo_rectangle_t*)) { rw->expose_event = f; }
+static inline void robwidget_set_size_request (RobWidget* rw, void (*f) (RobWidget*, int*, int*)) { rw->size_request = f; }
+static inline void robwidget_set_size_allocate (RobWidget* rw, void (*f) (RobWidget*, int, int)) { rw->size_allocate = f; }
+static inline void robwidget_set_mousedown (RobWidget* rw, RobWidget* (*f) (RobWidget*, RobTkBtnEvent*)) { rw->mousedown = f; }
+static inline void robwidget_set_mouseup (RobWidget* rw, RobWidget* (*f) (RobWidget*, RobTkBtnEvent*)) { rw->mouseup = f; }
+static inline void robwidget_set_mousemove (RobWidget* rw, RobWidget* (*f) (RobWidget*, RobTkBtnEvent*)) { rw->mousemove = f; }
+static inline void robwidget_set_mousescroll (RobWidget* rw, RobWidget* (*f) (RobWidget*, RobTkBtnEvent*)) { rw->mousescroll = f; }
+static inline void robwidget_set_size (RobWidget* rw, int w, int h) { rw->area_w = w; rw->area_h = h; }
+static inline void robwidget_show (RobWidget* rw, bool resize) { rw->hidden = false; }
+static inline void robwidget_hide (RobWidget* rw, bool resize) { rw->hidden = true; }
+
+static inline RobWidget* rob_hbox_new (bool homogeneous, int padding) { return robwidget_new (NULL); }
+static inline void rob_hbox_child_pack (RobWidget* rw, RobWidget* chld, bool expand, bool fill) {}
+static inline void rob_box_destroy (RobWidget* rw) { free (rw); }
+static inline RobWidget* rob_table_new (int rows, int cols, bool homogeneous) { return robwidget_new (NULL); }
+static inline void rob_table_attach (RobWidget* rw, RobWidget* chld,
+    int left, int right, int top, int bottom, int xpad, int ypad, int xopt, int yopt) {}
+static inline void rob_table_destroy (RobWidget* rw) { free (rw); }
+
+/* drawing helpers */
+
+static inline void rounded_rectangle (cairo_t* cr, double x, double y, double w, double h, double r) {
+  cairo_rectangle (cr, x, y, w, h);
+}
+
+static inline void get_text_geometry (const char* txt, PangoFontDescription* font, int* tw, int* th) {
+  cairo_surface_t* tmp = cairo_image_surface_create (CAIRO_FORMAT_A8, 8, 8);
+  cairo_t* cr = cairo_create (tmp);
+  PangoLayout* pl = pango_cairo_create_layout (cr);
+  pango_layout_set_font_description (pl, font);
+  pango_layout_set_text (pl, txt, -1);
+  pango_layout_get_pixel_size (pl, tw, th);
+  g_object_unref (pl);
+  cairo_destroy (cr);
+  cairo_surface_destroy (tmp);
+}
+
+static inline bool rect_intersect (const cairo_rectangle_t* a, const cairo_rectangle_t* b) {
+  return !(a->x > b->x + b->width || b->x > a->x + a->width
+      || a->y > b->y + b->height || b->y > a->y + a->height);
+}
+
+/* widgets */
+
+#define HEADLESS_CALLBACK \
+  bool (*cb) (RobWidget*, void*); \
+  void* cbh
+
+typedef struct { RobWidget* rw; bool active; bool sensitive; HEADLESS_CALLBACK; } RobTkCBtn;
+typedef struct { RobWidget* rw; bool sensitive; HEADLESS_CALLBACK; } RobTkPBtn;
+typedef struct { RobWidget* rw; int active; int n; bool sensitive; } RobTkMBtn;
+typedef struct { RobWidget* rw; } RobTkLbl;
+typedef struct { RobWidget* rw; } RobTkSep;
+typedef struct {
+  RobWidget* rw;
+  float min, max, acc, cur, dfl;
+  int click_state;
+  int w_width, w_height;
+  int displaymode;
+  float dcol[4][4];
+  bool sensitive;
+  HEADLESS_CALLBACK;
+} RobTkDial;
+typedef struct { RobWidget* rw; RobTkDial* dial; } RobTkSpin;
+typedef struct { RobWidget* rw; float val[64]; int n; int cur; int dfl; bool sensitive; HEADLESS_CALLBACK; } RobTkSelect;
+
+static inline RobTkCBtn* robtk_cbtn_new (const char* txt, int led, bool flat) {
+  RobTkCBtn* d = (RobTkCBtn*) calloc (1, sizeof (RobTkCBtn));
+  d->rw = robwidget_new (d);
+  return d;
+}
+static inline void robtk_cbtn_destroy (RobTkCBtn* d) { free (d->rw); free (d); }
+static inline bool robtk_cbtn_get_active (RobTkCBtn* d) { return d->active; }
+static inline void robtk_cbtn_set_active (RobTkCBtn* d, bool a) {
+  if (d->active == a) return;
+  d->active = a;
+  if (d->cb) d->cb (d->rw, d->cbh);
+}
+static inline void robtk_cbtn_set_sensitive (RobTkCBtn* d, bool s) { d->sensitive = s; }
+static inline void robtk_cbtn_set_callback (RobTkCBtn* d, bool (*cb) (RobWidget*, void*), void* h) { d->cb = cb; d->cbh = h; }
+static inline void robtk_cbtn_set_color_on (RobTkCBtn* d, float r, float g, float b) {}
+static inline void robtk_cbtn_set_color_off (RobTkCBtn* d, float r, float g, float b) {}
+static inline RobWidget* robtk_cbtn_widget (RobTkCBtn* d) { return d->rw; }
+
+static inline RobTkPBtn* robtk_pbtn_new (const char* txt) {
+  RobTkPBtn* d = (RobTkPBtn*) calloc (1, sizeof (RobTkPBtn));
+  d->rw = robwidget_new (d);
+  return d;
+}
+static inline void robtk_pbtn_destroy (RobTkPBtn* d) { free (d->rw); free (d); }
+static inline void robtk_pbtn_set_sensitive (RobTkPBtn* d, bool s) { d->sensitive = s; }
+static inline void robtk_pbtn_set_callback (RobTkPBtn* d, bool (*cb) (RobWidget*, void*), void* h) { d->cb = cb; d->cbh = h; }
+static inline RobWidget* robtk_pbtn_widget (RobTkPBtn* d) { return d->rw; }
+
+static inline RobTkMBtn* robtk_mbtn_new (int n) {
+  RobTkMBtn* d = (RobTkMBtn*) calloc (1, sizeof (RobTkMBtn));
+  d->rw = robwidget_new (d);
+  d->n = n;
+  return d;
+}
+static inline void robtk_mbtn_destroy (RobTkMBtn* d) { free (d->rw); free (d); }
+static inline int  robtk_mbtn_get_active (RobTkMBtn* d) { return d->active; }
+static inline void robtk_mbtn_set_active (RobTkMBtn* d, int a) { d->active = a; }
+static inline void robtk_mbtn_set_sensitive (RobTkMBtn* d, bool s) { d->sensitive = s; }
+static inline void robtk_mbtn_set_leds_rgb (RobTkMBtn* d, const float* rgb) {}
+static inline RobWidget* robtk_mbtn_widget (RobTkMBtn* d) { return d->rw; }
+
+static inline RobTkLbl* robtk_lbl_new (const char* txt) {
+  RobTkLbl* d = (RobTkLbl*) calloc (1, sizeof (RobTkLbl));
+  d->rw = robwidget_new (d);
+  return d;
+}
+static inline void robtk_lbl_destroy (RobTkLbl* d) { free (d->rw); free (d); }
+static inline void robtk_lbl_set_alignment (RobTkLbl* d, float x, float y) {}
+static inline void robtk_lbl_set_text (RobTkLbl* d, const char* txt) {}
+static inline void robtk_lbl_set_sensitive (RobTkLbl* d, bool s) {}
+static inline RobWidget* robtk_lbl_widget (RobTkLbl* d) { return d->rw; }
+
+static inline RobTkSep* robtk_sep_new (bool horizontal) {
+  RobTkSep* d = (RobTkSep*) calloc (1, sizeof (RobTkSep));
+  d->rw = robwidget_new (d);
+  return d;
+}
+static inline void robtk_sep_destroy (RobTkSep* d) { free (d->rw); free (d); }
+static inline void robtk_sep_set_linewidth (RobTkSep* d, float w) {}
+static inline RobWidget* robtk_sep_widget (RobTkSep* d) { return d->rw; }
+
+static inline RobTkDial* robtk_dial_new_with_size (float min, float max, float step,
+    int width, int height, float cx, float cy, float radius) {
+  RobTkDial* d = (RobTkDial*) calloc (1, sizeof (RobTkDial));
+  d->rw = robwidget_new (d);
+  d->min = min;
+  d->max = max;
+  d->acc = step;
+  d->cur = min;
+  d->w_width = width;
+  d->w_height = height;
+  return d;
+}
+static inline RobTkDial* robtk_dial_new (float min, float max, float step) {
+  return robtk_dial_new_with_size (min, max, step, GSP_WIDTH, GSP_HEIGHT, GSP_CX, GSP_CY, GSP_RADIUS);
+}
+static inline void  robtk_dial_destroy (RobTkDial* d) { free (d->rw); free (d); }
+static inline float robtk_dial_get_value (RobTkDial* d) { return d->cur; }
+static inline void  robtk_dial_set_value (RobTkDial* d, float v) {
+  if (v < d->min) v = d->min;
+  if (v > d->max) v = d->max;
+  if (d->cur == v) return;
+  d->cur = v;
+  if (d->cb) d->cb (d->rw, d->cbh);
+}
+static inline void robtk_dial_set_default (RobTkDial* d, float v) { d->dfl = v; }
+static inline int  robtk_dial_get_state (RobTkDial* d) { return d->click_state; }
+static inline void robtk_dial_set_state (RobTkDial* d, int s) { d->click_state = s; }
+static inline void robtk_dial_enable_states (RobTkDial* d, int s) {}
+static inline void robtk_dial_set_state_color (RobTkDial* d, int s, float r, float g, float b, float a) {}
+static inline void robtk_dial_set_default_state (RobTkDial* d, int s) {}
+static inline void robtk_dial_set_sensitive (RobTkDial* d, bool s) { d->sensitive = s; }
+static inline void robtk_dial_set_alignment (RobTkDial* d, float x, float y) {}
+static inline void robtk_dial_set_callback (RobTkDial* d, bool (*cb) (RobWidget*, void*), void* h) { d->cb = cb; d->cbh = h; }
+static inline void robtk_dial_annotation_callback (RobTkDial* d, void (*cb) (RobTkDial*, cairo_t*, void*), void* h) {}
+static inline void robtk_dial_update_range (RobTkDial* d, float min, float max, float step) { d->min = min; d->max = max; d->acc = step; }
+static inline RobWidget* robtk_dial_widget (RobTkDial* d) { return d->rw; }
+
+static inline RobTkSpin* robtk_spin_new (float min, float max, float step) {
+  RobTkSpin* d = (RobTkSpin*) calloc (1, sizeof (RobTkSpin));
+  d->dial = robtk_dial_new (min, max, step);
+  d->rw = robwidget_new (d);
+  return d;
+}
+static inline void  robtk_spin_destroy (RobTkSpin* d) { robtk_dial_destroy (d->dial); free (d->rw); free (d); }
+static inline float robtk_spin_get_value (RobTkSpin* d) { return d->dial->cur; }
+static inline void  robtk_spin_set_value (RobTkSpin* d, float v) { robtk_dial_set_value (d->dial, v); }
+static inline void  robtk_spin_set_default (RobTkSpin* d, float v) { d->dial->dfl = v; }
+static inline void  robtk_spin_set_sensitive (RobTkSpin* d, bool s) { d->dial->sensitive = s; }
+static inline void  robtk_spin_set_alignment (RobTkSpin* d, float x, float y) {}
+static inline void  robtk_spin_label_width (RobTkSpin* d, float w1, float w2) {}
+static inline void  robtk_spin_set_label_pos (RobTkSpin* d, int p) {}
+static inline void  robtk_spin_set_callback (RobTkSpin* d, bool (*cb) (RobWidget*, void*), void* h) { robtk_dial_set_callback (d->dial, cb, h); }
+static inline void  robtk_spin_update_range (RobTkSpin* d, float min, float max, float step) { robtk_dial_update_range (d->dial, min, max, step); }
+static inline RobWidget* robtk_spin_widget (RobTkSpin* d) { return d->rw; }
+
+static inline RobTkSelect* robtk_select_new () {
+  RobTkSelect* d = (RobTkSelect*) calloc (1, sizeof (RobTkSelect));
+  d->rw = robwidget_new (d);
+  return d;
+}
+static inline void  robtk_select_destroy (RobTkSelect* d) { free (d->rw); free (d); }
+static inline void  robtk_select_add_item (RobTkSelect* d, float v, const char* txt) { if (d->n < 64) d->val[d->n++] = v; }
+static inline int   robtk_select_get_item (RobTkSelect* d) { return d->cur; }
+static inline float robtk_select_get_value (RobTkSelect* d) { return d->val[d->cur]; }
+static inline void  robtk_select_set_item (RobTkSelect* d, int i) {
+  if (i < 0 || i >= d->n || d->cur == i) return;
+  d->cur = i;
+  if (d->cb) d->cb (d->rw, d->cbh);
+}
+static inline void robtk_select_set_value (RobTkSelect* d, float v) {
+  for (int i = 0; i < d->n; ++i) {
+    if (d->val[i] == v) { robtk_select_set_item (d, i); return; }
+  }
+}
+static inline void robtk_select_set_default_item (RobTkSelect* d, int i) { d->dfl = i; }
+static inline void robtk_select_set_sensitive (RobTkSelect* d, bool s) { d->sensitive = s; }
+static inline void robtk_select_set_alignment (RobTkSelect* d, float x, float y) {}
+static inline void robtk_select_set_callback (RobTkSelect* d, bool (*cb) (RobWidget*, void*), void* h) { d->cb = cb; d->cbh = h; }
+static inline RobWidget* robtk_select_widget (RobTkSelect* d) { return d->rw; }
+
+#endif
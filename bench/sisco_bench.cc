@@ -0,0 +1,453 @@
+/* simple scope -- headless benchmark of the DSP -> UI data path
+ *
+ * Copyright (C) 2013 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The plugin and the UI are instantiated back to back, without a host,
+ * X11 or OpenGL. Every cycle synthetic audio is fed to the plugin's run(),
+ * the notify-port is passed on to the UI's port_event() and the display
+ * is rendered into a cairo image surface at a fixed frame-rate.
+ * Messages written by the UI are delivered to the plugin's control port
+ * in the next cycle.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "./robtk_headless.h"
+#include "../gui/sisco.c"
+
+#ifdef HAVE_LV2_1_18_6
+#include <lv2/core/lv2.h>
+#else
+#include <lv2/lv2plug.in/ns/lv2core/lv2.h>
+#endif
+
+extern "C" const LV2_Descriptor* lv2_descriptor (uint32_t index);
+
+#define BENCH_ATOMBUF (262144) // notify-port, large enough for 4 channels * 8192 samples
+#define BENCH_CTRLBUF (8192)   // control-port
+
+enum BenchSignal {
+  SIG_SINE = 0,
+  SIG_NOISE,
+  SIG_IMPULSE
+};
+
+typedef struct {
+  /* settings */
+  float    rate;
+  uint32_t block;
+  uint32_t n_channels;
+  float    seconds;
+  float    fps;
+  int      signal;
+  int      grid;
+  int      width, height;
+
+  /* URID map */
+  char   **urimap;
+  uint32_t urimap_len;
+  LV2_URID_Map map;
+  LV2_URID atom_Sequence;
+  LV2_URID atom_eventTransfer;
+
+  /* plugin */
+  const LV2_Descriptor* desc;
+  LV2_Handle dsp;
+  LV2_Atom_Sequence *control;
+  LV2_Atom_Sequence *notify;
+  float *input[MAX_CHANNELS];
+  float *output[MAX_CHANNELS];
+
+  /* UI */
+  SiScoUI *ui;
+  cairo_surface_t *sf;
+
+  /* signal generator */
+  uint64_t spos;
+  uint32_t rnd;
+} Bench;
+
+typedef struct {
+  uint64_t dsp_ns;
+  uint64_t ui_ns;
+  uint64_t draw_ns;
+  uint64_t n_samples; // per channel
+  uint64_t n_msgs;
+  uint64_t n_frames;
+} BenchResult;
+
+static inline uint64_t now_ns () {
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/******************************************************************************
+ * host
+ */
+
+static LV2_URID uri_to_id (LV2_URID_Map_Handle handle, const char* uri) {
+  Bench* b = (Bench*) handle;
+  for (uint32_t i = 0; i < b->urimap_len; ++i) {
+    if (!strcmp (b->urimap[i], uri)) {
+      return i + 1;
+    }
+  }
+  b->urimap = (char**) realloc (b->urimap, (b->urimap_len + 1) * sizeof (char*));
+  b->urimap[b->urimap_len] = strdup (uri);
+  return ++b->urimap_len;
+}
+
+static void clear_sequence (Bench* b, LV2_Atom_Sequence* seq, uint32_t capacity) {
+  seq->atom.type = capacity > 0 ? 0 : b->atom_Sequence;
+  seq->atom.size = capacity > 0 ? capacity : sizeof (LV2_Atom_Sequence_Body);
+  seq->body.unit = 0;
+  seq->body.pad  = 0;
+}
+
+/** UI -> plugin, queue the message for the next cycle */
+static void ui_write (LV2UI_Controller controller, uint32_t port_index,
+    uint32_t buffer_size, uint32_t format, const void* buffer)
+{
+  Bench* b = (Bench*) controller;
+  if (port_index != 0 || format != b->atom_eventTransfer) {
+    return;
+  }
+  const LV2_Atom* atom = (const LV2_Atom*) buffer;
+  const uint32_t ev_size = lv2_atom_pad_size (sizeof (LV2_Atom_Event) + atom->size);
+  if (sizeof (LV2_Atom) + b->control->atom.size + ev_size > BENCH_CTRLBUF) {
+    fprintf (stderr, "sisco_bench: control-port overflow, message dropped.\n");
+    return;
+  }
+  LV2_Atom_Event* ev = (LV2_Atom_Event*) ((uint8_t*) LV2_ATOM_BODY (&b->control->atom) + b->control->atom.size);
+  ev->time.frames = 0;
+  memcpy (&ev->body, atom, sizeof (LV2_Atom) + atom->size);
+  b->control->atom.size += ev_size;
+}
+
+static void generate (Bench* b, uint32_t n_samples) {
+  for (uint32_t c = 0; c < b->n_channels; ++c) {
+    float* d = b->input[c];
+    for (uint32_t i = 0; i < n_samples; ++i) {
+      const uint64_t p = b->spos + i;
+      switch (b->signal) {
+	case SIG_SINE:
+	  d[i] = .8f * sinf (2.f * M_PI * 1000.f * (c + 1) * (float)(p % (uint64_t)b->rate) / b->rate);
+	  break;
+	case SIG_NOISE:
+	  b->rnd = b->rnd * 1103515245 + 12345;
+	  d[i] = (b->rnd >> 8) / (float)(1 << 23) - 1.f;
+	  break;
+	case SIG_IMPULSE:
+	  d[i] = (p % (uint64_t)(b->rate / 10)) == c ? 1.f : 0.f;
+	  break;
+      }
+    }
+  }
+  b->spos += n_samples;
+}
+
+/******************************************************************************
+ * setup
+ */
+
+static int bench_init (Bench* b) {
+  b->map.handle = b;
+  b->map.map = uri_to_id;
+  b->atom_Sequence      = uri_to_id (b, LV2_ATOM__Sequence);
+  b->atom_eventTransfer = uri_to_id (b, LV2_ATOM__eventTransfer);
+
+  LV2_Feature map_feature = { LV2_URID__map, &b->map };
+  const LV2_Feature* features[] = { &map_feature, NULL };
+
+  b->desc = lv2_descriptor (2 * (b->n_channels - 1));
+  if (!b->desc || !(b->dsp = b->desc->instantiate (b->desc, b->rate, ".", features))) {
+    fprintf (stderr, "sisco_bench: cannot instantiate plugin.\n");
+    return -1;
+  }
+
+  b->control = (LV2_Atom_Sequence*) calloc (1, BENCH_CTRLBUF);
+  b->notify  = (LV2_Atom_Sequence*) calloc (1, BENCH_ATOMBUF);
+  clear_sequence (b, b->control, 0);
+  b->desc->connect_port (b->dsp, 0, b->control);
+  b->desc->connect_port (b->dsp, 1, b->notify);
+  for (uint32_t c = 0; c < b->n_channels; ++c) {
+    b->input[c]  = (float*) calloc (b->block, sizeof (float));
+    b->output[c] = (float*) calloc (b->block, sizeof (float));
+    b->desc->connect_port (b->dsp, 2 + 2 * c, b->input[c]);
+    b->desc->connect_port (b->dsp, 3 + 2 * c, b->output[c]);
+  }
+
+  RobWidget* widget;
+  b->ui = (SiScoUI*) instantiate (NULL, NULL, b->desc->URI, ".", ui_write, b, &widget, features);
+  if (!b->ui) {
+    fprintf (stderr, "sisco_bench: cannot instantiate UI.\n");
+    return -1;
+  }
+
+  SiScoUI* ui = b->ui;
+  if (b->width > 0 && b->height > 0) {
+    size_allocate (ui->darea, b->width + ANWIDTH, b->height + ANHEIGHT);
+  }
+  if (b->grid >= 0) {
+    robtk_select_set_item (ui->sel_speed, b->grid);
+  }
+  b->sf = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, DAWIDTH + ANWIDTH, DAHEIGHT + ANHEIGHT);
+  return 0;
+}
+
+static void bench_cleanup (Bench* b) {
+  if (b->ui) {
+    cleanup (b->ui);
+  }
+  if (b->dsp) {
+    b->desc->cleanup (b->dsp);
+  }
+  if (b->sf) {
+    cairo_surface_destroy (b->sf);
+  }
+  for (uint32_t c = 0; c < b->n_channels; ++c) {
+    free (b->input[c]);
+    free (b->output[c]);
+  }
+  free (b->control);
+  free (b->notify);
+  for (uint32_t i = 0; i < b->urimap_len; ++i) {
+    free (b->urimap[i]);
+  }
+  free (b->urimap);
+}
+
+/******************************************************************************
+ * benchmarks
+ */
+
+/** run plugin and UI for the configured duration */
+static void bench_run (Bench* b, BenchResult* r) {
+  SiScoUI* ui = b->ui;
+  const uint64_t n_total = b->seconds * b->rate;
+  const double spf = b->rate / b->fps; // samples per frame
+  double next_frame = spf;
+
+  memset (r, 0, sizeof (BenchResult));
+
+  while (r->n_samples < n_total) {
+    generate (b, b->block);
+    clear_sequence (b, b->notify, BENCH_ATOMBUF);
+
+    uint64_t t0 = now_ns ();
+    b->desc->run (b->dsp, b->block);
+    uint64_t t1 = now_ns ();
+    r->dsp_ns += t1 - t0;
+
+    clear_sequence (b, b->control, 0);
+
+    t0 = now_ns ();
+    const LV2_Atom_Sequence* seq = b->notify;
+    for (LV2_Atom_Event* ev = lv2_atom_sequence_begin (&seq->body);
+	!lv2_atom_sequence_is_end (&seq->body, seq->atom.size, ev);
+	ev = lv2_atom_sequence_next (ev))
+    {
+      port_event (ui, 1, lv2_atom_total_size (&ev->body), b->atom_eventTransfer, &ev->body);
+      ++r->n_msgs;
+    }
+    t1 = now_ns ();
+    r->ui_ns += t1 - t0;
+
+    r->n_samples += b->block;
+
+    if (r->n_samples >= next_frame) {
+      next_frame += spf;
+      cairo_rectangle_t area = { 0, 0, (double) DAWIDTH + ANWIDTH, (double) DAHEIGHT + ANHEIGHT };
+      t0 = now_ns ();
+      cairo_t* cr = cairo_create (b->sf);
+      expose_event (ui->darea, cr, &area);
+      cairo_destroy (cr);
+      cairo_surface_flush (b->sf);
+      t1 = now_ns ();
+      r->draw_ns += t1 - t0;
+      ++r->n_frames;
+    }
+  }
+}
+
+static void print_rate (const char* name, uint64_t ns, uint64_t n_samples) {
+  if (ns == 0 || n_samples == 0) {
+    printf ("%-36s %14s %10s\n", name, "-", "-");
+    return;
+  }
+  printf ("%-36s %14.0f %10.3f\n", name, n_samples * 1e9 / ns, ns / (double) n_samples);
+}
+
+static void print_result (Bench* b, const char* title, const BenchResult* r) {
+  const uint64_t n = r->n_samples * b->n_channels;
+  printf ("\n# %s\n", title);
+  printf ("%-36s %14s %10s\n", "", "samples/s", "ns/sample");
+  print_rate ("DSP run (tx_rawaudio)", r->dsp_ns, n);
+  print_rate ("UI port_event (update_scope)", r->ui_ns, n);
+  print_rate ("UI expose_event", r->draw_ns, n);
+  if (r->n_frames > 0) {
+    printf ("%-36s %14.3f ms/frame, %" PRIu64 " frames, %" PRIu64 " messages\n", "",
+	r->draw_ns * 1e-6 / r->n_frames, r->n_frames, r->n_msgs);
+  }
+}
+
+/** the upsampler on its own, for all factors the UI can use */
+static void bench_resampler (Bench* b) {
+  const uint32_t n_inp = 8192;
+  const uint32_t n_iter = 64;
+  float* inp = (float*) calloc (n_inp, sizeof (float));
+  float* out = (float*) calloc (n_inp * MAX_UPSAMPLING, sizeof (float));
+
+  for (uint32_t i = 0; i < n_inp; ++i) {
+    inp[i] = sinf (2.f * M_PI * 1000.f * i / b->rate);
+  }
+
+  printf ("\n# Resampler (hlen: %d)\n", SRC_HLEN);
+  printf ("%-36s %14s %10s\n", "", "samples/s", "ns/sample");
+  for (uint32_t f = 2; f <= MAX_UPSAMPLING; f *= 2) {
+    LV2S::Interpolator itp;
+    itp.setup (f, SRC_HLEN, SRC_FREL);
+    uint64_t ns = 0;
+    for (uint32_t k = 0; k < n_iter; ++k) {
+      itp.inp_count = n_inp;
+      itp.inp_data  = inp;
+      itp.out_count = n_inp * f;
+      itp.out_data  = out;
+      const uint64_t t0 = now_ns ();
+      itp.process ();
+      ns += now_ns () - t0;
+    }
+    char name[64];
+    snprintf (name, sizeof (name), "Interpolator x%d (input)", f);
+    print_rate (name, ns, (uint64_t) n_inp * n_iter);
+  }
+  free (inp);
+  free (out);
+}
+
+/******************************************************************************
+ * main
+ */
+
+static void usage (int status) {
+  printf ("sisco_bench - headless benchmark of the sisco.lv2 data path\n\n");
+  printf ("Usage: sisco_bench [ OPTIONS ]\n\n");
+  printf ("Options:\n"
+      " -b, --block <n>       samples per cycle (default 256)\n"
+      " -c, --channels <n>    number of channels 1..4 (default 2)\n"
+      " -f, --fps <n>         display frame-rate (default 25)\n"
+      " -g, --grid <n>        time-scale, index of the UI selector (default: UI's default)\n"
+      " -h, --help            display this help and exit\n"
+      " -r, --rate <n>        sample-rate (default 48000)\n"
+      " -s, --signal <name>   sine, noise or impulse (default sine)\n"
+      " -t, --time <sec>      duration of audio to process per test (default 10)\n"
+      " -W, --width <px>      width of the scope-area\n"
+      " -H, --height <px>     height of the scope-area\n"
+      "\n");
+  exit (status);
+}
+
+static const struct option long_options[] = {
+  { "block",    required_argument, 0, 'b' },
+  { "channels", required_argument, 0, 'c' },
+  { "fps",      required_argument, 0, 'f' },
+  { "grid",     required_argument, 0, 'g' },
+  { "help",     no_argument,       0, 'h' },
+  { "rate",     required_argument, 0, 'r' },
+  { "signal",   required_argument, 0, 's' },
+  { "time",     required_argument, 0, 't' },
+  { "width",    required_argument, 0, 'W' },
+  { "height",   required_argument, 0, 'H' },
+  { 0, 0, 0, 0 }
+};
+
+int main (int argc, char** argv) {
+  Bench b;
+  memset (&b, 0, sizeof (Bench));
+  b.rate = 48000;
+  b.block = 256;
+  b.n_channels = 2;
+  b.seconds = 10;
+  b.fps = 25;
+  b.signal = SIG_SINE;
+  b.grid = -1;
+  b.rnd = 1;
+
+  int c;
+  while ((c = getopt_long (argc, argv, "b:c:f:g:hr:s:t:W:H:", long_options, NULL)) != -1) {
+    switch (c) {
+      case 'b': b.block = atoi (optarg); break;
+      case 'c': b.n_channels = atoi (optarg); break;
+      case 'f': b.fps = atof (optarg); break;
+      case 'g': b.grid = atoi (optarg); break;
+      case 'h': usage (EXIT_SUCCESS); break;
+      case 'r': b.rate = atof (optarg); break;
+      case 's':
+	if      (!strcmp (optarg, "sine"))    b.signal = SIG_SINE;
+	else if (!strcmp (optarg, "noise"))   b.signal = SIG_NOISE;
+	else if (!strcmp (optarg, "impulse")) b.signal = SIG_IMPULSE;
+	else usage (EXIT_FAILURE);
+	break;
+      case 't': b.seconds = atof (optarg); break;
+      case 'W': b.width = atoi (optarg); break;
+      case 'H': b.height = atoi (optarg); break;
+      default: usage (EXIT_FAILURE); break;
+    }
+  }
+
+  if (b.n_channels < 1 || b.n_channels > 4 || b.block < 1 || b.block > 8192
+      || b.rate < 8000 || b.fps <= 0 || b.seconds <= 0) {
+    usage (EXIT_FAILURE);
+  }
+
+  if (bench_init (&b)) {
+    bench_cleanup (&b);
+    return EXIT_FAILURE;
+  }
+
+  SiScoUI* ui = b.ui;
+  printf ("sisco_bench: %d channel(s), %.0f Hz, %d samples/cycle, %.1f sec, %s, %dx%d px, %.3f ms/div\n",
+      b.n_channels, b.rate, b.block, b.seconds,
+      b.signal == SIG_SINE ? "sine" : b.signal == SIG_NOISE ? "noise" : "impulse",
+      DAWIDTH, DAHEIGHT, robtk_select_get_value (ui->sel_speed) * .001f);
+
+  BenchResult r;
+  bench_run (&b, &r);
+  print_result (&b, "Free running", &r);
+
+#ifdef WITH_TRIGGER
+  /* continuous trigger, includes process_trigger() */
+  robtk_select_set_item (ui->sel_trigger_mode, 2);
+  bench_run (&b, &r);
+  print_result (&b, "Continuous trigger (process_trigger)", &r);
+  robtk_select_set_item (ui->sel_trigger_mode, 0);
+#endif
+
+#ifdef WITH_RESAMPLING
+  bench_resampler (&b);
+#endif
+
+  bench_cleanup (&b);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/* simple scope -- real valued radix-2 FFT
+ *
+ * Copyright (C) 2013 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCO_FFT_H
+#define SCO_FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "./kernels.h" // SCO_HAVE_SSE2
+
+/* A real transform of size n is computed as a complex transform of
+ * size n/2 (even samples: real, odd samples: imaginary part) followed
+ * by a split into the n/2+1 bins of the real spectrum.
+ * Complex data is kept in separate re/im arrays, so that the butterflies
+ * of one stage are plain vector operations.
+ */
+typedef struct {
+  uint32_t n;      // real transform size, power of two
+  uint32_t *rev;   // bit-reversed index, n/2 entries
+  float *tw_re;    // twiddles, the stage with h butterflies uses [h .. 2h)
+  float *tw_im;
+  float *rt_re;    // e^(-2 pi i k / n), k < n/2, for the real split
+  float *rt_im;
+  float *re;       // result: bins 0 .. n/2
+  float *im;
+} ScoFFT;
+
+static void
+sco_fft_free (ScoFFT *f)
+{
+  free (f->rev);
+  free (f->tw_re); free (f->tw_im);
+  free (f->rt_re); free (f->rt_im);
+  free (f->re);    free (f->im);
+  f->rev = NULL;
+  f->tw_re = f->tw_im = f->rt_re = f->rt_im = f->re = f->im = NULL;
+  f->n = 0;
+}
+
+/** allocate tables and buffers for a transform of size n >= 4,
+ * returns false (and frees everything) if allocation fails */
+static bool
+sco_fft_init (ScoFFT *f, uint32_t n)
+{
+  const uint32_t m = n / 2;
+  uint32_t bits = 0;
+  while ((1u << bits) < m) { ++bits; }
+
+  f->n = n;
+  f->rev   = (uint32_t*) malloc (m * sizeof (uint32_t));
+  f->tw_re = (float*) malloc (m * sizeof (float));
+  f->tw_im = (float*) malloc (m * sizeof (float));
+  f->rt_re = (float*) malloc (m * sizeof (float));
+  f->rt_im = (float*) malloc (m * sizeof (float));
+  f->re    = (float*) malloc ((m + 1) * sizeof (float));
+  f->im    = (float*) malloc ((m + 1) * sizeof (float));
+  if (!f->rev || !f->tw_re || !f->tw_im || !f->rt_re || !f->rt_im || !f->re || !f->im) {
+    sco_fft_free (f);
+    return false;
+  }
+
+  for (uint32_t i = 0; i < m; ++i) {
+    uint32_t r = 0;
+    for (uint32_t b = 0; b < bits; ++b) {
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    f->rev[i] = r;
+  }
+  f->tw_re[0] = 1; f->tw_im[0] = 0; // unused
+  for (uint32_t h = 1; h < m; h <<= 1) {
+    for (uint32_t k = 0; k < h; ++k) {
+      f->tw_re[h + k] = cos (-M_PI * k / h);
+      f->tw_im[h + k] = sin (-M_PI * k / h);
+    }
+  }
+  for (uint32_t k = 0; k < m; ++k) {
+    f->rt_re[k] = cos (-2.0 * M_PI * k / n);
+    f->rt_im[k] = sin (-2.0 * M_PI * k / n);
+  }
+  return true;
+}
+
+/** one radix-2 stage: h butterflies per group */
+static inline void
+sco_fft_stage (float *re, float *im, uint32_t m, uint32_t h,
+    const float *tw_re, const float *tw_im)
+{
+  for (uint32_t i = 0; i < m; i += 2 * h) {
+    float *ar = &re[i], *ai = &im[i];
+    float *br = &re[i + h], *bi = &im[i + h];
+    uint32_t k = 0;
+#ifdef SCO_HAVE_SSE2
+    for (; k + 4 <= h; k += 4) {
+      const __m128 wr = _mm_loadu_ps (&tw_re[k]);
+      const __m128 wi = _mm_loadu_ps (&tw_im[k]);
+      const __m128 xr = _mm_loadu_ps (&br[k]);
+      const __m128 xi = _mm_loadu_ps (&bi[k]);
+      const __m128 tr = _mm_sub_ps (_mm_mul_ps (xr, wr), _mm_mul_ps (xi, wi));
+      const __m128 ti = _mm_add_ps (_mm_mul_ps (xr, wi), _mm_mul_ps (xi, wr));
+      const __m128 yr = _mm_loadu_ps (&ar[k]);
+      const __m128 yi = _mm_loadu_ps (&ai[k]);
+      _mm_storeu_ps (&br[k], _mm_sub_ps (yr, tr));
+      _mm_storeu_ps (&bi[k], _mm_sub_ps (yi, ti));
+      _mm_storeu_ps (&ar[k], _mm_add_ps (yr, tr));
+      _mm_storeu_ps (&ai[k], _mm_add_ps (yi, ti));
+    }
+#endif
+    for (; k < h; ++k) {
+      const float tr = br[k] * tw_re[k] - bi[k] * tw_im[k];
+      const float ti = br[k] * tw_im[k] + bi[k] * tw_re[k];
+      br[k] = ar[k] - tr;
+      bi[k] = ai[k] - ti;
+      ar[k] += tr;
+      ai[k] += ti;
+    }
+  }
+}
+
+/** forward transform of n real samples,
+ * the result is in f->re[0 .. n/2], f->im[0 .. n/2] */
+static void
+sco_fft_forward (ScoFFT *f, const float *in)
+{
+  const uint32_t m = f->n / 2;
+  float *re = f->re;
+  float *im = f->im;
+
+  for (uint32_t j = 0; j < m; ++j) {
+    re[f->rev[j]] = in[2 * j];
+    im[f->rev[j]] = in[2 * j + 1];
+  }
+
+  for (uint32_t h = 1; h < m; h <<= 1) {
+    sco_fft_stage (re, im, m, h, &f->tw_re[h], &f->tw_im[h]);
+  }
+
+  /* split the half-size complex spectrum Z into the real one X:
+   * X[k] = (Z[k] + Z*[m-k]) / 2 + W^k (Z[k] - Z*[m-k]) / 2i */
+  const float z0r = re[0];
+  const float z0i = im[0];
+  for (uint32_t k = 1; k <= m / 2; ++k) {
+    const uint32_t j = m - k;
+    const float evr = .5f * (re[k] + re[j]);
+    const float evi = .5f * (im[k] - im[j]);
+    const float odr = .5f * (im[k] + im[j]);
+    const float odi = -.5f * (re[k] - re[j]);
+    const float tr = f->rt_re[k] * odr - f->rt_im[k] * odi;
+    const float ti = f->rt_re[k] * odi + f->rt_im[k] * odr;
+    re[k] = evr + tr;
+    im[k] = evi + ti;
+    re[j] = evr - tr;
+    im[j] = ti - evi;
+  }
+  re[0] = z0r + z0i;
+  im[0] = 0;
+  re[m] = z0r - z0i;
+  im[m] = 0;
+}
+
+#endif
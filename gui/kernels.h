@@ -0,0 +1,408 @@
+/* simple scope -- vectorized sample reduction
+ *
+ * Copyright (C) 2013 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCO_KERNELS_H
+#define SCO_KERNELS_H
+
+#include <stdint.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#define SCO_HAVE_SSE2
+#endif
+
+/* runtime dispatch, AVX code is compiled with a target attribute.
+ * (not on windows: gcc does not align the stack for AVX spills there) */
+#if defined(SCO_HAVE_SSE2) && defined(__GNUC__) && !defined(_WIN32)
+#include <immintrin.h>
+#define SCO_HAVE_AVX
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SCO_HAVE_NEON
+#endif
+
+/** reduce a block of samples into a display column:
+ * *vmin = min (*vmin, data[]), *vmax = max (*vmax, data[]),
+ * *sumsq += sum (data[]^2)
+ *
+ * NaN samples do not change min/max in any of the variants:
+ * the scalar comparison is false for them, the SSE/AVX min/max
+ * return their 2nd operand if either is NaN, so the accumulator
+ * goes last. NEON's min/max propagate NaN, it uses compare/select.
+ */
+typedef void (*sco_reduce_fn) (const float *data, uint32_t n,
+    float *vmin, float *vmax, float *sumsq);
+
+static void
+sco_reduce_scalar (const float *data, uint32_t n,
+    float *vmin, float *vmax, float *sumsq)
+{
+  float d_min = *vmin;
+  float d_max = *vmax;
+  float d_sum = *sumsq;
+  for (uint32_t i = 0; i < n; ++i) {
+    if (data[i] < d_min) { d_min = data[i]; }
+    if (data[i] > d_max) { d_max = data[i]; }
+    d_sum += data[i] * data[i];
+  }
+  *vmin = d_min;
+  *vmax = d_max;
+  *sumsq = d_sum;
+}
+
+#ifdef SCO_HAVE_SSE2
+static void
+sco_reduce_sse2 (const float *data, uint32_t n,
+    float *vmin, float *vmax, float *sumsq)
+{
+  /* align to 16 bytes */
+  while (n > 0 && ((uintptr_t)data & 15)) {
+    sco_reduce_scalar (data, 1, vmin, vmax, sumsq);
+    ++data; --n;
+  }
+  if (n >= 4) {
+    __m128 v_min = _mm_set1_ps (*vmin);
+    __m128 v_max = _mm_set1_ps (*vmax);
+    __m128 v_sum = _mm_setzero_ps ();
+    for (; n >= 4; n -= 4, data += 4) {
+      const __m128 x = _mm_load_ps (data);
+      v_min = _mm_min_ps (x, v_min);
+      v_max = _mm_max_ps (x, v_max);
+      v_sum = _mm_add_ps (v_sum, _mm_mul_ps (x, x));
+    }
+    /* horizontal reduction */
+    v_min = _mm_min_ps (v_min, _mm_movehl_ps (v_min, v_min));
+    v_min = _mm_min_ss (v_min, _mm_shuffle_ps (v_min, v_min, 1));
+    v_max = _mm_max_ps (v_max, _mm_movehl_ps (v_max, v_max));
+    v_max = _mm_max_ss (v_max, _mm_shuffle_ps (v_max, v_max, 1));
+    v_sum = _mm_add_ps (v_sum, _mm_movehl_ps (v_sum, v_sum));
+    v_sum = _mm_add_ss (v_sum, _mm_shuffle_ps (v_sum, v_sum, 1));
+    _mm_store_ss (vmin, v_min);
+    _mm_store_ss (vmax, v_max);
+    *sumsq += _mm_cvtss_f32 (v_sum);
+  }
+  sco_reduce_scalar (data, n, vmin, vmax, sumsq);
+}
+#endif
+
+#ifdef SCO_HAVE_AVX
+__attribute__((target("avx")))
+static void
+sco_reduce_avx (const float *data, uint32_t n,
+    float *vmin, float *vmax, float *sumsq)
+{
+  /* align to 32 bytes */
+  while (n > 0 && ((uintptr_t)data & 31)) {
+    sco_reduce_scalar (data, 1, vmin, vmax, sumsq);
+    ++data; --n;
+  }
+  if (n >= 8) {
+    __m256 v_min = _mm256_set1_ps (*vmin);
+    __m256 v_max = _mm256_set1_ps (*vmax);
+    __m256 v_sum = _mm256_setzero_ps ();
+    for (; n >= 8; n -= 8, data += 8) {
+      const __m256 x = _mm256_load_ps (data);
+      v_min = _mm256_min_ps (x, v_min);
+      v_max = _mm256_max_ps (x, v_max);
+      v_sum = _mm256_add_ps (v_sum, _mm256_mul_ps (x, x));
+    }
+    /* fold to 128 bit, then horizontal reduction */
+    __m128 m_min = _mm_min_ps (_mm256_castps256_ps128 (v_min), _mm256_extractf128_ps (v_min, 1));
+    __m128 m_max = _mm_max_ps (_mm256_castps256_ps128 (v_max), _mm256_extractf128_ps (v_max, 1));
+    __m128 m_sum = _mm_add_ps (_mm256_castps256_ps128 (v_sum), _mm256_extractf128_ps (v_sum, 1));
+    m_min = _mm_min_ps (m_min, _mm_movehl_ps (m_min, m_min));
+    m_min = _mm_min_ss (m_min, _mm_shuffle_ps (m_min, m_min, 1));
+    m_max = _mm_max_ps (m_max, _mm_movehl_ps (m_max, m_max));
+    m_max = _mm_max_ss (m_max, _mm_shuffle_ps (m_max, m_max, 1));
+    m_sum = _mm_add_ps (m_sum, _mm_movehl_ps (m_sum, m_sum));
+    m_sum = _mm_add_ss (m_sum, _mm_shuffle_ps (m_sum, m_sum, 1));
+    _mm_store_ss (vmin, m_min);
+    _mm_store_ss (vmax, m_max);
+    *sumsq += _mm_cvtss_f32 (m_sum);
+  }
+  _mm256_zeroupper ();
+  sco_reduce_scalar (data, n, vmin, vmax, sumsq);
+}
+#endif
+
+#ifdef SCO_HAVE_NEON
+static void
+sco_reduce_neon (const float *data, uint32_t n,
+    float *vmin, float *vmax, float *sumsq)
+{
+  if (n >= 4) {
+    float32x4_t v_min = vdupq_n_f32 (*vmin);
+    float32x4_t v_max = vdupq_n_f32 (*vmax);
+    float32x4_t v_sum = vdupq_n_f32 (0);
+    for (; n >= 4; n -= 4, data += 4) {
+      const float32x4_t x = vld1q_f32 (data);
+      v_min = vbslq_f32 (vcltq_f32 (x, v_min), x, v_min);
+      v_max = vbslq_f32 (vcgtq_f32 (x, v_max), x, v_max);
+      v_sum = vmlaq_f32 (v_sum, x, x);
+    }
+    float32x2_t p_min = vmin_f32 (vget_low_f32 (v_min), vget_high_f32 (v_min));
+    float32x2_t p_max = vmax_f32 (vget_low_f32 (v_max), vget_high_f32 (v_max));
+    float32x2_t p_sum = vadd_f32 (vget_low_f32 (v_sum), vget_high_f32 (v_sum));
+    p_min = vpmin_f32 (p_min, p_min);
+    p_max = vpmax_f32 (p_max, p_max);
+    p_sum = vpadd_f32 (p_sum, p_sum);
+    *vmin = vget_lane_f32 (p_min, 0);
+    *vmax = vget_lane_f32 (p_max, 0);
+    *sumsq += vget_lane_f32 (p_sum, 0);
+  }
+  sco_reduce_scalar (data, n, vmin, vmax, sumsq);
+}
+#endif
+
+/** boxcar sum of a block of samples (hi-res acquisition):
+ * *sum += sum (data[])
+ */
+static void
+sco_reduce_sum (const float *data, uint32_t n, float *sum)
+{
+  uint32_t i = 0;
+  float d_sum = *sum;
+#ifdef SCO_HAVE_SSE2
+  if (n >= 8) {
+    __m128 v_s0 = _mm_setzero_ps ();
+    __m128 v_s1 = _mm_setzero_ps ();
+    for (; i + 8 <= n; i += 8) {
+      v_s0 = _mm_add_ps (v_s0, _mm_loadu_ps (&data[i]));
+      v_s1 = _mm_add_ps (v_s1, _mm_loadu_ps (&data[i + 4]));
+    }
+    v_s0 = _mm_add_ps (v_s0, v_s1);
+    v_s0 = _mm_add_ps (v_s0, _mm_movehl_ps (v_s0, v_s0));
+    v_s0 = _mm_add_ss (v_s0, _mm_shuffle_ps (v_s0, v_s0, 1));
+    d_sum += _mm_cvtss_f32 (v_s0);
+  }
+#endif
+  for (; i < n; ++i) {
+    d_sum += data[i];
+  }
+  *sum = d_sum;
+}
+
+/** merge display columns into an envelope and back (envelope acquisition):
+ * emin[] = min (emin[], vmin[]), emax[] = max (emax[], vmax[]),
+ * vmin[] = emin[], vmax[] = emax[]
+ */
+static void
+sco_envelope (float *vmin, float *vmax, float *emin, float *emax, uint32_t n)
+{
+  uint32_t i = 0;
+#ifdef SCO_HAVE_SSE2
+  for (; i + 4 <= n; i += 4) {
+    /* operand order as in sco_reduce_sse2(), NaN columns are skipped */
+    const __m128 lo = _mm_min_ps (_mm_loadu_ps (&vmin[i]), _mm_loadu_ps (&emin[i]));
+    const __m128 hi = _mm_max_ps (_mm_loadu_ps (&vmax[i]), _mm_loadu_ps (&emax[i]));
+    _mm_storeu_ps (&emin[i], lo);
+    _mm_storeu_ps (&emax[i], hi);
+    _mm_storeu_ps (&vmin[i], lo);
+    _mm_storeu_ps (&vmax[i], hi);
+  }
+#endif
+  for (; i < n; ++i) {
+    if (vmin[i] < emin[i]) { emin[i] = vmin[i]; }
+    if (vmax[i] > emax[i]) { emax[i] = vmax[i]; }
+    vmin[i] = emin[i];
+    vmax[i] = emax[i];
+  }
+}
+
+/** linear sweep averaging: sum[] += x[] */
+static void
+sco_accumulate (const float *x, float *sum, uint32_t n)
+{
+  uint32_t i = 0;
+#ifdef SCO_HAVE_SSE2
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps (&sum[i], _mm_add_ps (_mm_loadu_ps (&sum[i]), _mm_loadu_ps (&x[i])));
+  }
+#endif
+  for (; i < n; ++i) {
+    sum[i] += x[i];
+  }
+}
+
+/** normalize a sum: y[] = x[] * gain */
+static void
+sco_scale (const float *x, float *y, uint32_t n, float gain)
+{
+  uint32_t i = 0;
+#ifdef SCO_HAVE_SSE2
+  const __m128 vg = _mm_set1_ps (gain);
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps (&y[i], _mm_mul_ps (_mm_loadu_ps (&x[i]), vg));
+  }
+#endif
+  for (; i < n; ++i) {
+    y[i] = x[i] * gain;
+  }
+}
+
+/** exponential sweep averaging: avg[] += alpha * (x[] - avg[]) */
+static void
+sco_blend (const float *x, float *avg, uint32_t n, float alpha)
+{
+  uint32_t i = 0;
+#ifdef SCO_HAVE_SSE2
+  const __m128 va = _mm_set1_ps (alpha);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 a = _mm_loadu_ps (&avg[i]);
+    _mm_storeu_ps (&avg[i], _mm_add_ps (a, _mm_mul_ps (va, _mm_sub_ps (_mm_loadu_ps (&x[i]), a))));
+  }
+#endif
+  for (; i < n; ++i) {
+    avg[i] += alpha * (x[i] - avg[i]);
+  }
+}
+
+/** map x/y sample pairs to pixels of a (1 << bits)^2 row-major image:
+ * u = m[0] * x + m[1] * y, v = m[2] * x + m[3] * y,
+ * [-1..+1] spans the image, v points up, values outside are clamped,
+ * NaN maps to 0 (a single NaN must not index outside of the image).
+ */
+static void
+sco_xy_index (const float *x, const float *y, uint32_t n,
+    const float m[4], uint32_t bits, int32_t *idx)
+{
+  const float half = .5f * ((1 << bits) - 1);
+  uint32_t i = 0;
+#ifdef SCO_HAVE_SSE2
+  const __m128 m0 = _mm_set1_ps (m[0] * half);
+  const __m128 m1 = _mm_set1_ps (m[1] * half);
+  const __m128 m2 = _mm_set1_ps (-m[2] * half);
+  const __m128 m3 = _mm_set1_ps (-m[3] * half);
+  const __m128 ctr = _mm_set1_ps (half);
+  const __m128 lo = _mm_setzero_ps ();
+  const __m128 hi = _mm_set1_ps (2.f * half);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 vx = _mm_loadu_ps (&x[i]);
+    const __m128 vy = _mm_loadu_ps (&y[i]);
+    __m128 u = _mm_add_ps (ctr, _mm_add_ps (_mm_mul_ps (m0, vx), _mm_mul_ps (m1, vy)));
+    __m128 v = _mm_add_ps (ctr, _mm_add_ps (_mm_mul_ps (m2, vx), _mm_mul_ps (m3, vy)));
+    /* maxps returns the 2nd operand if either is NaN: NaN maps to 'lo' */
+    u = _mm_min_ps (hi, _mm_max_ps (u, lo));
+    v = _mm_min_ps (hi, _mm_max_ps (v, lo));
+    const __m128i col = _mm_cvtps_epi32 (u);
+    const __m128i row = _mm_cvtps_epi32 (v);
+    _mm_storeu_si128 ((__m128i*) &idx[i],
+	_mm_add_epi32 (_mm_sll_epi32 (row, _mm_cvtsi32_si128 (bits)), col));
+  }
+#endif
+  for (; i < n; ++i) {
+    float u = half + half * (m[0] * x[i] + m[1] * y[i]);
+    float v = half - half * (m[2] * x[i] + m[3] * y[i]);
+    u = !(u > 0) ? 0 : (u > 2.f * half ? 2.f * half : u); // NaN -> 0
+    v = !(v > 0) ? 0 : (v > 2.f * half ? 2.f * half : v);
+    idx[i] = ((int32_t)(v + .5f) << bits) + (int32_t)(u + .5f);
+  }
+}
+
+/** decay a density image and convert it to 8bit:
+ * d[] *= decay, pix[] = min (255, sqrt (d[] * scale)).
+ * Values below 'floor' are cleared to avoid denormals.
+ */
+static void
+sco_xy_fade (float *d, uint8_t *pix, uint32_t n,
+    float decay, float scale, float floor)
+{
+  uint32_t i = 0;
+#ifdef SCO_HAVE_SSE2
+  const __m128 vd = _mm_set1_ps (decay);
+  const __m128 vs = _mm_set1_ps (scale);
+  const __m128 vf = _mm_set1_ps (floor);
+  const __m128 v255 = _mm_set1_ps (255.f);
+  for (; i + 16 <= n; i += 16) {
+    __m128i q[4];
+    for (int k = 0; k < 4; ++k) {
+      __m128 v = _mm_mul_ps (_mm_loadu_ps (&d[i + 4 * k]), vd);
+      v = _mm_and_ps (v, _mm_cmpge_ps (v, vf));
+      _mm_storeu_ps (&d[i + 4 * k], v);
+      q[k] = _mm_cvttps_epi32 (_mm_min_ps (v255, _mm_sqrt_ps (_mm_mul_ps (v, vs))));
+    }
+    const __m128i w0 = _mm_packs_epi32 (q[0], q[1]);
+    const __m128i w1 = _mm_packs_epi32 (q[2], q[3]);
+    _mm_storeu_si128 ((__m128i*) &pix[i], _mm_packus_epi16 (w0, w1));
+  }
+#endif
+  for (; i < n; ++i) {
+    float v = d[i] * decay;
+    if (v < floor) { v = 0; }
+    d[i] = v;
+    v = sqrtf (v * scale);
+    pix[i] = v > 255.f ? 255 : (uint8_t) v;
+  }
+}
+
+/** power spectrum with exponential averaging:
+ * avg[] += alpha * (re[]^2 + im[]^2 + 1e-20 - avg[])
+ * (the offset, -200dB, keeps the average clear of denormals).
+ * Bins with a non-finite power (NaN or Inf input) keep their average,
+ * otherwise a single NaN would stick to it.
+ */
+static void
+sco_power_avg (const float *re, const float *im, float *avg,
+    uint32_t n, float alpha)
+{
+  uint32_t i = 0;
+#ifdef SCO_HAVE_SSE2
+  const __m128 va = _mm_set1_ps (alpha);
+  const __m128 vo = _mm_set1_ps (1e-20f);
+  const __m128 vm = _mm_set1_ps (HUGE_VALF);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 r = _mm_loadu_ps (&re[i]);
+    const __m128 m = _mm_loadu_ps (&im[i]);
+    const __m128 p = _mm_add_ps (_mm_add_ps (_mm_mul_ps (r, r), _mm_mul_ps (m, m)), vo);
+    const __m128 a = _mm_loadu_ps (&avg[i]);
+    const __m128 ok = _mm_cmplt_ps (p, vm); // false for NaN and Inf
+    const __m128 u = _mm_add_ps (a, _mm_mul_ps (va, _mm_sub_ps (p, a)));
+    _mm_storeu_ps (&avg[i], _mm_or_ps (_mm_and_ps (ok, u), _mm_andnot_ps (ok, a)));
+  }
+#endif
+  for (; i < n; ++i) {
+    const float p = re[i] * re[i] + im[i] * im[i] + 1e-20f;
+    if (p < HUGE_VALF) {
+      avg[i] += alpha * (p - avg[i]);
+    }
+  }
+}
+
+/** pick the best kernel for the CPU at hand */
+static sco_reduce_fn
+sco_reduce_select (void)
+{
+#ifdef SCO_HAVE_AVX
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx")) {
+    return sco_reduce_avx;
+  }
+#endif
+#if defined SCO_HAVE_SSE2
+  return sco_reduce_sse2;
+#elif defined SCO_HAVE_NEON
+  return sco_reduce_neon;
+#else
+  return sco_reduce_scalar;
+#endif
+}
+
+#endif
@@ -22,13 +22,41 @@
 #define WITH_RESAMPLING
 #define WITH_MARKERS
 #define WITH_AMP_LABEL
+#define WITH_DECIMATION
+#define WITH_PYRAMID
+#define WITH_DEEPMEM
+#define WITH_DSP_TRIGGER
+#define WITH_XYMODE
+#define WITH_PHOSPHOR
+#define WITH_SPECTRUM
+#define WITH_ACQMODES
+#define WITH_SWEEPAVG
+#define WITH_SEGMENTS
 #undef  DEBUG_WAVERENDER
 #undef  WITH_TIME_ADJ
+#undef  WITH_PROFILING
 ///////////////////////
 
+#if defined WITH_DEEPMEM && !defined WITH_PYRAMID
+#undef WITH_DEEPMEM // the summary-index is a pyramid
+#endif
+
+#if defined WITH_DSP_TRIGGER && !defined WITH_TRIGGER
+#undef WITH_DSP_TRIGGER
+#endif
+
+#if defined WITH_SWEEPAVG && !defined WITH_TRIGGER
+#undef WITH_SWEEPAVG // averages triggered sweeps
+#endif
+
+#if defined WITH_SEGMENTS && !defined WITH_TRIGGER
+#undef WITH_SEGMENTS
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <time.h>
 
 #ifdef HAVE_LV2_1_18_6
 #include <lv2/ui/ui.h>
@@ -37,12 +65,15 @@
 #endif
 
 #include "../src/uris.h"
+#include "../src/trigger.h"
+#include "./kernels.h"
+#include "./fft.h"
 
 #define RTK_URI SCO_URI "#"
 #define RTK_GUI "ui"
 
 #ifdef WITH_RESAMPLING
-#include "./zita-resampler/resampler.h"
+#include "./zita-resampler/interpolator.h"
 using namespace LV2S;
 #endif
 
@@ -99,18 +130,14 @@ static const int _CHNY[4][4] = {
 //#define ANRTEXT  (DAWIDTH + ANWIDTH - 20)  // annotation right-aligned text
 #define ANRTEXT  (DAWIDTH - 2)  // annotation right-aligned text
 
-/* trigger buffer - 2 * sizeof max audio-buffer size
- * times two becasue with trigger pos at 100% it must be able
- * to hold the prev buffer and the next buffer without
- * overwriting the any data.
- */
 #ifdef WITH_RESAMPLING
 #define MAX_UPSAMPLING (32)
-#define TRBUFSZ  (16384 * MAX_UPSAMPLING)
-#else
-#define TRBUFSZ  (16384)
 #endif
 
+/* minimum stride for which the DSP is asked to send
+ * min/max/rms columns (12 bytes) instead of raw samples */
+#define DECIM_MIN_STRIDE (8)
+
 typedef struct {
   float *data_min;
   float *data_max;
@@ -119,9 +146,223 @@ typedef struct {
   uint32_t idx;
   uint32_t sub;
   uint32_t bufsiz;
-  pthread_mutex_t lock;
+  float    shift; // sub-column offset of a triggered capture
 } ScoChan;
 
+/* triple-buffer to hand display data from the communication
+ * thread (producer) to the drawing thread (consumer) without locking.
+ * Producer and consumer each own one buffer, the third one is
+ * exchanged atomically via 'mid', see snap_publish(), snap_acquire().
+ */
+#define SNAP_FRESH (4)
+
+typedef struct {
+  int mid;   // index of the spare buffer, | SNAP_FRESH if published
+  int back;  // owned by producer
+  int front; // owned by consumer
+} ScoTriple;
+
+typedef struct {
+  ScoChan buf[3];
+  ScoTriple tb;
+} ScoSnap;
+
+/* persistent waveform image of a channel (alpha only).
+ * expose_event() compares the displayed columns with the ones
+ * that were painted last time and only re-renders what changed,
+ * the layer is then composited in the channel's color.
+ */
+typedef struct {
+  cairo_surface_t *sf;
+  float   *painted; // min, max of every column as painted
+  uint32_t width;
+  int      y0;      // top of the layer on the scope-area
+  int      height;
+  float    gain;
+  float    yoff;
+  float    so;
+} ScoLayer;
+
+#ifdef WITH_PYRAMID
+/* power-of-two min/max/rms history at the native sample-rate,
+ * level k holds columns of (1 << k) samples. It allows to
+ * re-render the display when the time-scale changes.
+ */
+#define PYR_BASE   (3)  // lowest level, 8 samples per column
+#define PYR_LEVELS (16) // up to 32768 samples per column
+
+typedef struct {
+  ScoChan  lvl[PYR_LEVELS]; // ring of columns, [idx] is the partial column
+  uint32_t fill[PYR_LEVELS]; // number of complete columns
+  uint32_t lo;   // lowest allocated level
+  uint32_t base; // lowest level that is currently fed
+} ScoPyramid;
+#endif
+
+#ifdef WITH_DEEPMEM
+/* long history of raw audio, browseable while paused.
+ * The depth is selectable (sel_deep: seconds, 0: off) */
+#define DEEPMEM_CHUNK   (65536) // samples per chunk
+#define DEEPMEM_BASE    (6)     // summary-index, 64 samples per column and up
+
+typedef struct {
+  float  **chunk;     // raw audio ring, see setup_deep()
+  uint32_t n_chunks;
+  uint64_t pos;       // total number of samples written
+  uint64_t raw_from;  // first sample that has raw data
+  float    rate;      // memory is sized for this sample-rate
+  ScoPyramid sum;     // min/max/rms summary-index
+} ScoDeep;
+
+/* deep-memory view, browsed in the GUI thread (mouse_scroll()) and
+ * handed to port_event() as one snapshot, see deep_req */
+typedef struct {
+  uint32_t stride; // samples per column
+  uint64_t ago;    // right edge, samples before the most recent one
+  int      epoch;  // deep_epoch when the view was started
+} ScoDeepView;
+#endif
+
+/* what the scope-area shows, saved in ui_state_misc */
+enum DisplayMode {
+  DM_SCOPE = 0,
+  DM_XY,    // Lissajous, channel pairs 1/2 and 3/4
+  DM_GONIO, // same, rotated by 45deg: mid (L+R) up, side (R-L) across
+  DM_PHOSPHOR, // intensity graded persistence of the time-domain trace
+  DM_SPECTRUM, // FFT, log-frequency
+};
+
+#ifdef WITH_SEGMENTS
+/* segmented memory (trigger mode 3): consecutive triggered windows
+ * are cut from the trigger-buffer, which keeps recording, into an
+ * arena that is allocated when the capture starts (and kept while the
+ * number of segments and the width do not grow).
+ * The trigger re-arms at the end of each window.
+ */
+#define SEG_MAX (128)    // max number of segments
+#define SEG_PENDING (32) // triggers waiting for their post-trigger data
+
+typedef struct {
+  uint64_t col;  // trigger-buffer column, counted since arming
+  uint64_t time; // sample-position
+  float    frac; // sub-column position of the crossing
+} ScoSegTrig;
+#endif
+
+#ifdef WITH_ACQMODES
+/* how samples are reduced to a display-column, saved in ui_state_misc */
+enum AcqMode {
+  AM_PEAK = 0,  // min/max of all samples
+  AM_SAMPLE,    // first sample only
+  AM_HIRES,     // boxcar average
+  AM_ENVELOPE,  // min/max, accumulated across sweeps
+};
+#endif
+
+#ifdef WITH_XYMODE
+/* X/Y display of a channel pair.
+ * port_event() splats sample pairs into a float density image and,
+ * XY_FPS times per second, decays it and publishes an 8bit copy
+ * (triple-buffered, like ScoSnap), which expose_event() uses as mask.
+ */
+#define XY_BITS (9)
+#define XY_SIZE (1 << XY_BITS) // 512 x 512 px
+#define XY_FPS  (60)
+#define XY_PERSISTENCE (.25f) // decay time-constant [s]
+#define XY_CHUNK (256) // sample-pairs per call to sco_xy_index()
+
+typedef struct {
+  float   *density; // XY_SIZE * XY_SIZE, row-major, owned by port_event()
+  float   *xbuf;    // 1st channel of the pair, waiting for the 2nd
+  uint32_t xlen;
+  uint32_t xsiz;
+  uint32_t fill;    // samples since the last publish
+  uint8_t *pix[3];
+  cairo_surface_t *sf[3];
+  ScoTriple tb;
+} ScoXY;
+#endif
+
+#ifdef WITH_PHOSPHOR
+/* digital phosphor: per channel hit-count histogram of display-column
+ * and amplitude, column-major. A column decays when the sweep re-enters
+ * it. port_event() maps it through a color-map into an image and
+ * publishes that (triple-buffered) at PH_FPS; expose_event() paints
+ * one image per channel.
+ */
+#define PH_BINS  (256)  // amplitude bins
+#define PH_RANGE (1.5f) // bins span [-PH_RANGE..+PH_RANGE] of the amplitude, after gain
+#define PH_HITS  (1024) // total weight of the samples of a column, per sweep
+#define PH_DECAY (3)    // a column keeps 7/8 of its hits per sweep
+#define PH_SHIFT (5)    // hits -> color-map index
+#define PH_FPS   (30)
+
+typedef struct {
+  uint16_t *hits;   // [column * PH_BINS + bin], owned by port_event()
+  uint32_t  width;  // columns
+  uint32_t  weight; // per sample: PH_HITS / stride
+  float     gain;   // the histogram is valid for this gain..
+  uint32_t  stride; // ..and time-scale
+  uint32_t  fill;   // samples since the last publish
+  uint32_t  lut[256]; // color-map, premultiplied ARGB
+  uint32_t *pix[3];
+  cairo_surface_t *sf[3];
+  ScoTriple tb;
+} ScoPhosphor;
+#endif
+
+#ifdef WITH_SPECTRUM
+/* spectrum: every channel keeps the most recent samples in a ring,
+ * each hop a Hann-windowed FFT of the last fft_size samples is added
+ * to the averaged power spectrum. At SPEC_FPS the bins are reduced to
+ * display-columns (log-frequency, max of the bins in each column)
+ * and published triple-buffered.
+ */
+#define SPEC_MIN_LOG2 (10) // 1k
+#define SPEC_MAX_LOG2 (16) // 64k
+#define SPEC_MAX (1 << SPEC_MAX_LOG2)
+#define SPEC_FPS (30)
+#define SPEC_FMIN (20.f)
+#define SPEC_DBRANGE (120.f) // display range: 0 .. -120 dBFS
+
+typedef struct {
+  float   *ring;   // SPEC_MAX most recent samples
+  uint32_t pos;    // write position in ring
+  uint32_t hop;    // samples since the last transform
+  uint32_t fill;   // samples since the last publish
+  float   *pwr;    // averaged power of bins 0 .. fft_size/2
+  bool     reset;  // next transform initializes the average and peak
+  float   *peak;   // peak-hold [dBFS] per display-column, owned by port_event()
+  float   *col[3]; // level, peak [dBFS] per display column, triple-buffered
+  uint32_t width;
+  ScoTriple tb;
+} ScoSpec;
+#endif
+
+/* stages of the hot-path, see prof_add() */
+enum {
+  PROF_RUN = 0, // DSP run(), reported by the backend
+  PROF_SCOPE,   // update_scope_real() and friends, per message
+  PROF_SRC,     // upsampling, per message
+  PROF_EXPOSE,  // expose_event()
+  PROF_LAST
+};
+
+#ifdef WITH_PROFILING
+#define PROF_BINS (32)        // log2 histogram, bin k: [2^k .. 2^(k+1)) ns
+#define PROF_CSV_INTERVAL (5) // seconds between reports on stderr
+#define PROF_FRAME_NS (40000000.0) // frame budget: 25 fps
+#define PROF_OVERLAY_W (300)
+#define PROF_OVERLAY_H (100)
+
+typedef struct {
+  uint32_t hist[PROF_BINS];
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+} ScoProf;
+#endif
+
 #ifdef WITH_MARKERS
 typedef struct {
   uint32_t xpos;
@@ -131,7 +372,8 @@ typedef struct {
 #endif
 
 typedef struct {
-  LV2_Atom_Forge forge;
+  LV2_Atom_Forge forge;    // GUI thread: ui_enable(), ui_disable(), template for ui_state()
+  LV2_Atom_Forge forge_pe; // used from port_event() only
   LV2_URID_Map*  map;
   ScoLV2URIs     uris;
 
@@ -150,18 +392,90 @@ typedef struct {
   RobTkCBtn *btn_mem[MAX_CHANNELS];
   RobTkDial *spb_amp[MAX_CHANNELS];
   RobTkSelect *sel_speed;
+  RobTkSelect *sel_display;
+#ifdef WITH_ACQMODES
+  RobTkSelect *sel_acq;
+#endif
+#ifdef WITH_SPECTRUM
+  RobTkSelect *sel_fft_size;
+  RobTkSelect *sel_fft_avg;
+  RobTkCBtn   *btn_fft_peak;
+#endif
   RobTkDial *spb_yoff[MAX_CHANNELS], *spb_xoff[MAX_CHANNELS];
   bool visible[MAX_CHANNELS];
 
   cairo_surface_t *gridnlabels;
   PangoFontDescription *font[4];
 
-  ScoChan  chn[MAX_CHANNELS];
-  ScoChan  mem[MAX_CHANNELS];
+  ScoChan  chn[MAX_CHANNELS]; // written by port_event()
+  ScoSnap  snap[MAX_CHANNELS];
+  ScoChan *dpy[MAX_CHANNELS]; // current snapshot used for drawing
+  ScoChan  mem[MAX_CHANNELS]; // hold, owned by drawing thread
+  ScoLayer layer[MAX_CHANNELS]; // owned by drawing thread
+#ifdef WITH_PYRAMID
+  ScoPyramid pyr[MAX_CHANNELS];
+#endif
+#ifdef WITH_DEEPMEM
+  ScoDeep  deep[MAX_CHANNELS]; // owned by port_event()
+  bool     deep_view;   // display shows deep-memory (while paused), owned by port_event()
+  ScoDeepView deep_cur; // view that is shown, owned by port_event()
+  ScoDeepView deep_gui; // view that is browsed, owned by the GUI thread
+  ScoDeepView deep_req[3]; // GUI -> port_event(), triple-buffered
+  ScoTriple deep_tb;
+  int      deep_epoch;  // port_event() closed the view (resume), older requests are void
+  int      deep_dirty;  // memory changed, port_event() re-renders
+  RobTkSelect *sel_deep;
+#endif
+#ifdef WITH_XYMODE
+  ScoXY    xy[MAX_CHANNELS / 2];
+#endif
+#ifdef WITH_PHOSPHOR
+  ScoPhosphor ph[MAX_CHANNELS];
+#endif
+#ifdef WITH_SPECTRUM
+  ScoSpec  spec[MAX_CHANNELS];
+  ScoFFT   fft;       // plan, owned by port_event()
+  float   *fft_win;   // Hann window
+  float   *fft_in;    // windowed input
+  float    fft_norm;  // power of a full-scale sine -> 0dBFS
+  uint32_t *fft_col;  // first bin of every display-column, width + 1
+  uint32_t fft_size;
+  uint32_t fft_hop;
+  float    fft_alpha; // averaging, 1: off
+  bool     fft_peak;
+  float    fft_rate;  // fft_col is valid for this rate and width
+  uint32_t fft_width;
+#endif
+  int      display; // enum DisplayMode, set by port_event()
+#ifdef WITH_ACQMODES
+  int      acq_mode; // enum AcqMode, set by port_event()
+  ScoChan  env[MAX_CHANNELS];      // min/max across sweeps, idx: last seen position
+  bool     env_wrap[MAX_CHANNELS]; // chn holds a complete sweep
+#endif
+  bool     mem_ok[MAX_CHANNELS];
+  pthread_mutex_t resize_lock;
+  sco_reduce_fn reduce; // min/max/sum-of-squares kernel
   float    xoff[MAX_CHANNELS];
   float    yoff[MAX_CHANNELS];
   float    gain[MAX_CHANNELS];
   bool     hold[MAX_CHANNELS];
+  bool     idle[MAX_CHANNELS];   // DSP does not send data (hidden)
+  bool     resync[MAX_CHANNELS]; // DSP resumed sending data
+  uint32_t want; // channels requested from DSP, bitmask
+
+  /* display range changed in the current cycle, see note_scope_redraw() */
+  bool     rdw_set;
+  int      rdw_overflow;
+  uint32_t rdw_start, rdw_end;
+
+  /* lost message accounting, see rx_account() */
+  bool     rx_valid[MAX_CHANNELS];
+  uint32_t rx_seq[MAX_CHANNELS];  // next expected sequence number
+  uint64_t rx_next[MAX_CHANNELS]; // next expected sample-position
+  uint64_t rx_msgs;
+  uint64_t rx_lost;
+  uint64_t rx_lost_rep; // rx_lost at the last report
+  uint64_t rx_rep_pos;  // sample-position of the last report
   float    grid_spacing;
   uint32_t stride;
   uint32_t stride_vis;
@@ -171,6 +485,9 @@ typedef struct {
   float    rate;
   uint32_t cur_period;
   bool     error;
+#ifdef WITH_DECIMATION
+  uint32_t decim_stride; // requested from DSP, 0: raw audio
+#endif
 
 #ifdef DEBUG_WAVERENDER
   bool     solidwave;
@@ -179,6 +496,14 @@ typedef struct {
 #ifdef WITH_TIME_ADJ
   RobTkSpin     *spb_speed_adj;
 #endif
+#ifdef WITH_PROFILING
+  RobTkCBtn *btn_profile;
+  bool     profile;    // set by the button
+  bool     prof_dsp;   // backend was asked to report run()
+  ScoProf  prof[PROF_LAST]; // every stage has a single writer thread
+  uint64_t prof_since; // start of profiling [ns]
+  uint64_t prof_csv;   // time of the next report [ns], 0: print header
+#endif
 
   uint32_t  w_height;
 
@@ -190,6 +515,12 @@ typedef struct {
   RobTkSpin     *spb_trigger_pos;
   RobTkSpin     *spb_trigger_hld;
   RobTkLbl      *lbl_tpos, *lbl_tlvl, *lbl_thld;
+  RobTkSelect   *sel_trigger_kind;
+  RobTkSpin     *spb_trigger_par;
+  RobTkLbl      *lbl_tpar;
+  RobTkSelect   *sel_trigger_hfr;
+  RobTkSpin     *spb_trigger_hys;
+  RobTkLbl      *lbl_thys;
 
   uint32_t trigger_cfg_pos;
   float    trigger_cfg_lvl;
@@ -197,23 +528,65 @@ typedef struct {
 
   uint32_t trigger_cfg_mode;
   uint32_t trigger_cfg_type;
+  uint32_t trigger_cfg_kind;
+  float    trigger_cfg_par;
+  float    trigger_cfg_hys;
+  float    trigger_cfg_hfr;
 
   enum TriggerState trigger_state;
   enum TriggerState trigger_state_n;
 
   ScoChan  trigger_buf[MAX_CHANNELS];
-  float    trigger_prev;
+  ScoTrigger trigger;
+  uint32_t trigger_bufsiz; // columns, see reserve_trigger_buf()
   uint32_t trigger_offset;
+  float    trigger_frac; // sub-column position of the crossing
   uint32_t trigger_delay;
   bool     trigger_collect_ok;
   bool     trigger_manual;
 #endif
+#ifdef WITH_SEGMENTS
+  RobTkSelect *sel_seg_num;
+  RobTkSpin   *spb_seg_show;
+  RobTkLbl    *lbl_tshow;
+  ScoChan  *seg;       // arena, seg_size * n_channels, see alloc_segments()
+  uint64_t seg_time[SEG_MAX];
+  uint32_t seg_size;   // allocated segments
+  uint32_t seg_width;  // allocated columns per segment
+  uint32_t seg_num;    // segments to capture
+  uint32_t seg_count;  // captured segments
+  int      seg_show;   // segment in chn: 1 .. seg_count, 0: overlay of all
+  uint64_t seg_cols;   // trigger-buffer columns since arming
+  uint64_t seg_armed;  // first column that can trigger
+  uint64_t seg_adv;    // columns added in the current period
+  uint64_t seg_samples; // samples since arming
+  ScoSegTrig seg_pend[SEG_PENDING];
+  uint32_t seg_pend_n;
+#endif
+#ifdef WITH_SWEEPAVG
+  RobTkSelect *sel_trigger_avg;
+  ScoChan  avg_sum[MAX_CHANNELS]; // linear: sum of the current block of sweeps
+  ScoChan  avg[MAX_CHANNELS];     // the average, displayed instead of chn
+  uint32_t avg_n;     // sweeps to average, 0: off
+  bool     avg_exp;   // exponential, rather than linear blocks of avg_n
+  uint32_t avg_count; // sweeps in avg_sum (linear) or avg (exponential)
+  bool     avg_held;  // avg holds a complete block (linear)
+#endif
+#ifdef WITH_DSP_TRIGGER
+  bool     trigger_dsp; // the DSP looks for the trigger
+  bool     trigger_win[MAX_CHANNELS]; // current message starts the triggered window
+  bool     trigger_abort; // the DSP trigger gave up
+  bool     trigger_dsp_fail; // do not re-arm the DSP trigger
+  uint64_t trigger_nowin; // raw audio received instead of the triggered window
+#endif
 
 #ifdef WITH_RESAMPLING
-  Resampler *src[MAX_CHANNELS];
+  Interpolator *src[MAX_CHANNELS]; // current, one of src_cache[][src_fact]
+  Interpolator *src_cache[MAX_CHANNELS][MAX_UPSAMPLING + 1];
   float src_fact;
   float src_fact_vis;
-  float src_buf[MAX_CHANNELS][TRBUFSZ]; // TODO dyn alloc
+  float *src_buf[MAX_CHANNELS]; // upsampled data, see reserve_src_buf()
+  uint32_t src_bufsiz;
 #endif
 
 #ifdef WITH_MARKERS
@@ -278,39 +651,178 @@ static void marker_control_sensitivity(SiScoUI* ui, bool en);
 /******************************************************************************
  * Setup re-sampling (upsample)
  */
-static void setup_src(SiScoUI* ui, float oversample) {
-  const int hlen = 16; // 8..96
-  const float frel = 1.0; // 1.0 - 2.6 / (float) hlen;
-  uint32_t bsiz = 8192;
-  float *scratch = (float*) calloc(bsiz, sizeof(float));
-  float *resampl = (float*) malloc(bsiz * oversample * sizeof(float));
+#define SRC_HLEN (16) // 8..96
+#define SRC_CHUNK (64) // input samples per step of update_scope_upsampled()
+#define SRC_FREL (1.0) // 1.0 - 2.6 / (float) hlen;
 
-  ui->src_fact = oversample;
+/** set up upsamplers for all factors once,
+ * changing the time-scale later does not allocate anything */
+static void init_src_cache(SiScoUI* ui) {
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    ui->src[c] = 0;
+    ui->src_cache[c][0] = ui->src_cache[c][1] = 0;
+    for (uint32_t f = 2; f <= MAX_UPSAMPLING; ++f) {
+      ui->src_cache[c][f] = new Interpolator();
+      ui->src_cache[c][f]->setup(f, SRC_HLEN, SRC_FREL);
+    }
+  }
+}
 
+static void free_src_cache(SiScoUI* ui) {
   for (uint32_t c = 0; c < ui->n_channels; ++c) {
-    if (ui->src[c] != 0) {
-      delete ui->src[c];
-      ui->src[c] = 0;
+    ui->src[c] = 0;
+    for (uint32_t f = 0; f <= MAX_UPSAMPLING; ++f) {
+      delete ui->src_cache[c][f];
+      ui->src_cache[c][f] = 0;
     }
-    if (oversample <= 1) continue;
+  }
+}
 
-    ui->src[c] = new Resampler();
-    ui->src[c]->setup(ui->rate, ui->rate * oversample, 1, hlen, frel);
+static void setup_src(SiScoUI* ui, float oversample) {
+  const uint32_t f = MIN(MAX_UPSAMPLING, rintf(oversample));
+  ui->src_fact = oversample;
 
-    /* q/d initialize */
-    ui->src[c]->inp_count = bsiz;
-    ui->src[c]->inp_data = scratch;
-    ui->src[c]->out_count = bsiz * oversample;
-    ui->src[c]->out_data = resampl;
-    ui->src[c]->process ();
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    ui->src[c] = f > 1 ? ui->src_cache[c][f] : 0;
+    if (ui->src[c]) {
+      /* drop history of previous use */
+      ui->src[c]->reset();
+    }
   }
+}
 
-  free(scratch);
-  free(resampl);
+/** grow upsampling buffers to hold n samples per channel.
+ * returns false and keeps the current buffers if allocation fails */
+static bool reserve_src_buf(SiScoUI* ui, const uint32_t n) {
+  if (n <= ui->src_bufsiz) {
+    return true;
+  }
+  float *buf[MAX_CHANNELS];
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    buf[c] = (float*) malloc(n * sizeof(float));
+    if (!buf[c]) {
+      while (c > 0) { free(buf[--c]); }
+      return false;
+    }
+  }
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    free(ui->src_buf[c]);
+    ui->src_buf[c] = buf[c];
+  }
+  ui->src_bufsiz = n;
+  return true;
 }
 #endif
 
 
+/******************************************************************************
+ * Profiling
+ */
+
+#ifdef WITH_PROFILING
+static const char *prof_name[PROF_LAST] = { "run", "scope", "resample", "expose" };
+
+static inline uint64_t prof_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline uint64_t prof_start(SiScoUI* ui) {
+  return ui->profile ? prof_now() : 0;
+}
+
+static inline uint64_t prof_since(const uint64_t t0) {
+  return t0 > 0 ? prof_now() - t0 : 0;
+}
+
+/** add a sample to the histogram of a stage.
+ * There is no lock, every stage is written by a single thread
+ * and readers may see a slightly inconsistent set of counters.
+ */
+static void prof_add(SiScoUI* ui, const int stage, const uint64_t ns) {
+  if (!ui->profile) {
+    return;
+  }
+  ScoProf *p = &ui->prof[stage];
+  const uint32_t bin = ns > 1 ? MIN(PROF_BINS - 1, 63 - __builtin_clzll(ns)) : 0;
+  __atomic_fetch_add(&p->hist[bin], 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&p->sum, ns, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&p->count, 1, __ATOMIC_RELAXED);
+  if (ns > __atomic_load_n(&p->max, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&p->max, ns, __ATOMIC_RELAXED);
+  }
+}
+
+static inline void prof_stop(SiScoUI* ui, const int stage, const uint64_t t0) {
+  if (t0 > 0) {
+    prof_add(ui, stage, prof_now() - t0);
+  }
+}
+
+/** upper bound of the q-quantile [ns] */
+static uint64_t prof_quantile(const ScoProf *p, const double q) {
+  const uint64_t n = __atomic_load_n(&p->count, __ATOMIC_RELAXED);
+  uint64_t acc = 0;
+  if (n == 0) {
+    return 0;
+  }
+  for (uint32_t k = 0; k < PROF_BINS; ++k) {
+    acc += __atomic_load_n(&p->hist[k], __ATOMIC_RELAXED);
+    if (acc >= q * n) {
+      return 2ULL << k;
+    }
+  }
+  return __atomic_load_n(&p->max, __ATOMIC_RELAXED);
+}
+
+/** periodic summary as CSV on stderr, runs in the communication thread */
+static void prof_report(SiScoUI* ui) {
+  const uint64_t now = prof_now();
+  if (now < ui->prof_csv) {
+    return;
+  }
+  if (ui->prof_csv == 0) {
+    fprintf(stderr, "sisco-prof,time_s,stage,count,mean_ns,p50_ns,p99_ns,max_ns,lost_msgs\n");
+  }
+  ui->prof_csv = now + PROF_CSV_INTERVAL * 1000000000ULL;
+
+  for (uint32_t i = 0; i < PROF_LAST; ++i) {
+    const ScoProf *p = &ui->prof[i];
+    const uint64_t n = __atomic_load_n(&p->count, __ATOMIC_RELAXED);
+    fprintf(stderr, "sisco-prof,%.1f,%s,%llu,%llu,%llu,%llu,%llu,%llu\n",
+	(now - ui->prof_since) * 1e-9, prof_name[i],
+	(unsigned long long) n,
+	(unsigned long long) (n > 0 ? __atomic_load_n(&p->sum, __ATOMIC_RELAXED) / n : 0),
+	(unsigned long long) prof_quantile(p, .5),
+	(unsigned long long) prof_quantile(p, .99),
+	(unsigned long long) __atomic_load_n(&p->max, __ATOMIC_RELAXED),
+	(unsigned long long) ui->rx_lost);
+  }
+}
+
+/** complete histograms as CSV on stderr */
+static void prof_dump(SiScoUI* ui) {
+  fprintf(stderr, "sisco-hist,stage,bin_ns,count\n");
+  for (uint32_t i = 0; i < PROF_LAST; ++i) {
+    for (uint32_t k = 0; k < PROF_BINS; ++k) {
+      const uint32_t n = __atomic_load_n(&ui->prof[i].hist[k], __ATOMIC_RELAXED);
+      if (n > 0) {
+	fprintf(stderr, "sisco-hist,%s,%llu,%u\n", prof_name[i], 1ULL << k, n);
+      }
+    }
+  }
+}
+
+#else
+
+static inline uint64_t prof_start(SiScoUI* ui) { return 0; }
+static inline uint64_t prof_since(const uint64_t t0) { return 0; }
+static inline void prof_add(SiScoUI* ui, const int stage, const uint64_t ns) { }
+static inline void prof_stop(SiScoUI* ui, const int stage, const uint64_t t0) { }
+
+#endif
+
 /******************************************************************************
  * Allocate Data structures
  */
@@ -319,6 +831,7 @@ static void setup_src(SiScoUI* ui, float oversample) {
 static void zero_sco_chan(ScoChan *sc) {
   sc->idx = 0;
   sc->sub = 0;
+  sc->shift = 0;
   memset(sc->data_min, 0, sizeof(float) * sc->bufsiz);
   memset(sc->data_max, 0, sizeof(float) * sc->bufsiz);
   memset(sc->data_rms, 0, sizeof(float) * sc->bufsiz);
@@ -329,11 +842,9 @@ static void alloc_sco_chan(ScoChan *sc) {
   sc->data_max = (float*) malloc(sizeof(float) * sc->bufsiz);
   sc->data_rms = (float*) malloc(sizeof(float) * sc->bufsiz);
   zero_sco_chan(sc);
-  pthread_mutex_init(&sc->lock, NULL);
 }
 
 static void free_sco_chan(ScoChan *sc) {
-  pthread_mutex_destroy(&sc->lock);
   free(sc->data_min);
   free(sc->data_max);
   free(sc->data_rms);
@@ -350,136 +861,1204 @@ static void realloc_sco_chan(ScoChan *sc, uint32_t size) {
   zero_sco_chan(sc);
 }
 
-
-#ifdef WITH_TRIGGER
-static inline void setup_trigger(SiScoUI* ui) {
-  ui->trigger_state_n = TS_INITIALIZING;
+/** like realloc_sco_chan(), but keeps the buffer if allocation fails */
+static bool try_realloc_sco_chan(ScoChan *sc, uint32_t size) {
+  float *d_min = (float*) malloc(sizeof(float) * size);
+  float *d_max = (float*) malloc(sizeof(float) * size);
+  float *d_rms = (float*) malloc(sizeof(float) * size);
+  if (!d_min || !d_max || !d_rms) {
+    free(d_min);
+    free(d_max);
+    free(d_rms);
+    return false;
+  }
+  free_sco_chan(sc);
+  sc->bufsiz = size;
+  sc->data_min = d_min;
+  sc->data_max = d_max;
+  sc->data_rms = d_rms;
+  zero_sco_chan(sc);
+  return true;
 }
-static inline void next_tigger_state(SiScoUI* ui, enum TriggerState next) {
-  if (ui->trigger_state_n == TS_DISABLED || ui->trigger_state == TS_DISABLED) return;
-  ui->trigger_state_n = next;
+
+static void copy_sco_chan(ScoChan *dst, const ScoChan *src) {
+  const uint32_t n = MIN(dst->bufsiz, src->bufsiz);
+  memcpy(dst->data_min, src->data_min, sizeof(float) * n);
+  memcpy(dst->data_max, src->data_max, sizeof(float) * n);
+  memcpy(dst->data_rms, src->data_rms, sizeof(float) * n);
+  dst->idx = src->idx;
+  dst->sub = src->sub;
+  dst->shift = src->shift;
 }
-#endif
 
+static void snap_init(ScoTriple *t) {
+  t->front = 0;
+  t->mid   = 1;
+  t->back  = 2;
+}
 
-/******************************************************************************
- * Communication with DSP backend -- send/receive settings
- */
+/** producer: publish the back-buffer, continue with the spare one */
+static void snap_publish(ScoTriple *t) {
+  t->back = __atomic_exchange_n(&t->mid, t->back | SNAP_FRESH, __ATOMIC_ACQ_REL) & 3;
+}
 
+/** consumer: pick up the most recently published buffer, if any.
+ * returns true if 'front' changed */
+static bool snap_acquire(ScoTriple *t) {
+  if (__atomic_load_n(&t->mid, __ATOMIC_ACQUIRE) & SNAP_FRESH) {
+    t->front = __atomic_exchange_n(&t->mid, t->front, __ATOMIC_ACQ_REL) & 3;
+    return true;
+  }
+  return false;
+}
 
-/** send current settings to backend */
-static void ui_state(LV2UI_Handle handle)
-{
-  SiScoUI* ui = (SiScoUI*)handle;
-  uint8_t obj_buf[4096];
-  struct channelstate cs[MAX_CHANNELS];
-  const int32_t grid = robtk_select_get_item(ui->sel_speed);
-  int32_t misc = 0;
+static void alloc_sco_snap(ScoSnap *ss, uint32_t size) {
+  for (int i = 0; i < 3; ++i) {
+    ss->buf[i].bufsiz = size;
+    alloc_sco_chan(&ss->buf[i]);
+  }
+  snap_init(&ss->tb);
+}
 
-  if (robtk_cbtn_get_active(ui->btn_latch)) {
-    misc |= 1;
+static void free_sco_snap(ScoSnap *ss) {
+  for (int i = 0; i < 3; ++i) {
+    free_sco_chan(&ss->buf[i]);
   }
-  if (robtk_cbtn_get_active(ui->btn_align)) {
-    misc |= 2;
+}
+
+static void realloc_sco_snap(ScoSnap *ss, uint32_t size) {
+  for (int i = 0; i < 3; ++i) {
+    realloc_sco_chan(&ss->buf[i], size);
   }
+  snap_init(&ss->tb);
+}
 
-#ifdef WITH_TRIGGER
-  struct triggerstate ts;
-  ts.mode = robtk_select_get_item(ui->sel_trigger_mode);
-  ts.type = robtk_select_get_item(ui->sel_trigger_type);
-  ts.xpos = robtk_spin_get_value(ui->spb_trigger_pos);
-  ts.hold = robtk_spin_get_value(ui->spb_trigger_hld);
-  ts.level= robtk_spin_get_value(ui->spb_trigger_lvl);
-#endif
+/** producer: copy the current state into the back-buffer
+ * and swap it with the spare buffer */
+static void publish_sco_snap(ScoSnap *ss, const ScoChan *sc) {
+  copy_sco_chan(&ss->buf[ss->tb.back], sc);
+  snap_publish(&ss->tb);
+}
 
-#ifdef WITH_MARKERS
-  struct cursorstate ms;
-  ms.xpos[0] = robtk_dial_get_value(ui->spb_marker_x0);
-  ms.xpos[1] = robtk_dial_get_value(ui->spb_marker_x1);
-  ms.chn[0] = robtk_spin_get_value(ui->spb_marker_c0);
-  ms.chn[1] = robtk_spin_get_value(ui->spb_marker_c1);
-#endif
+/** consumer: pick up the most recently published buffer, if any */
+static ScoChan * acquire_sco_snap(ScoSnap *ss) {
+  snap_acquire(&ss->tb);
+  return &ss->buf[ss->tb.front];
+}
 
+/** drawing thread: update display data before rendering,
+ * take a copy for channels that were just put on hold */
+static void acquire_display(SiScoUI* ui) {
   for (uint32_t c = 0; c < ui->n_channels; ++c) {
-    uint32_t opts = 0;
-    if (robtk_cbtn_get_active(ui->btn_chn[c])) opts |= 1;
-#ifdef WITH_MARKERS
-    opts |= (robtk_mbtn_get_active(ui->btn_ann[c])) << 1;
-#endif
-    cs[c].gain = db_to_coefficient(robtk_dial_get_value(ui->spb_amp[c]));
-    if (robtk_dial_get_state(ui->spb_amp[c]) == 1) cs[c].gain *= -1;
-    cs[c].xoff = robtk_dial_get_value(ui->spb_xoff[c]);
-    cs[c].yoff = robtk_dial_get_value(ui->spb_yoff[c]);
-    cs[c].opts = opts;
+    ui->dpy[c] = acquire_sco_snap(&ui->snap[c]);
+    if (!ui->hold[c]) {
+      ui->mem_ok[c] = false;
+    } else if (!ui->mem_ok[c]) {
+      copy_sco_chan(&ui->mem[c], ui->dpy[c]);
+      ui->mem_ok[c] = true;
+    }
   }
+}
 
-  lv2_atom_forge_set_buffer(&ui->forge, obj_buf, 1024);
-  LV2_Atom_Forge_Frame frame;
-  lv2_atom_forge_frame_time(&ui->forge, 0);
-  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge, &frame, 1, ui->uris.ui_state);
+static inline ScoChan * display_chn(SiScoUI* ui, uint32_t c) {
+  return ui->hold[c] && ui->mem_ok[c] ? &ui->mem[c] : ui->dpy[c];
+}
 
+#ifdef WITH_PYRAMID
+static void zero_pyramid_level(ScoPyramid *p, uint32_t k) {
+  zero_sco_chan(&p->lvl[k]);
+  p->lvl[k].data_min[0] =  1.0;
+  p->lvl[k].data_max[0] = -1.0;
+  p->fill[k] = 0;
+}
 
-  lv2_atom_forge_property_head(&ui->forge, ui->uris.ui_state_grid, 0);
-  lv2_atom_forge_int(&ui->forge, grid);
+static void zero_pyramid(ScoPyramid *p) {
+  for (uint32_t k = p->lo; k < PYR_LEVELS; ++k) {
+    zero_pyramid_level(p, k);
+  }
+  p->base = p->lo;
+}
 
-  lv2_atom_forge_property_head(&ui->forge, ui->uris.ui_state_misc, 0);
-  lv2_atom_forge_int(&ui->forge, misc);
+/** allocate levels lo .. PYR_LEVELS-1, every level holds at least
+ * two screens and covers at least 'history' samples */
+static void alloc_pyramid(ScoPyramid *p, uint32_t lo, uint32_t width, uint64_t history) {
+  p->lo = lo;
+  for (uint32_t k = lo; k < PYR_LEVELS; ++k) {
+    p->lvl[k].bufsiz = MAX(2 * width, (history >> k) + 1);
+    alloc_sco_chan(&p->lvl[k]);
+  }
+  zero_pyramid(p);
+}
 
-#ifdef WITH_TRIGGER
-  lv2_atom_forge_property_head(&ui->forge, ui->uris.ui_state_trig, 0);
-  lv2_atom_forge_vector(&ui->forge, sizeof(float), ui->uris.atom_Float,
-      sizeof(struct triggerstate) / sizeof(float), &ts);
-#endif
-#ifdef WITH_MARKERS
-  lv2_atom_forge_property_head(&ui->forge, ui->uris.ui_state_curs, 0);
-  lv2_atom_forge_vector(&ui->forge, sizeof(int32_t), ui->uris.atom_Int,
-      sizeof(struct cursorstate) / sizeof(int32_t), &ms);
-#endif
-  lv2_atom_forge_property_head(&ui->forge, ui->uris.ui_state_chn, 0);
-  lv2_atom_forge_vector(&ui->forge, sizeof(float), ui->uris.atom_Float,
-      ui->n_channels * sizeof(struct channelstate) / sizeof(float), cs);
+static void free_pyramid(ScoPyramid *p) {
+  for (uint32_t k = p->lo; k < PYR_LEVELS; ++k) {
+    free_sco_chan(&p->lvl[k]);
+  }
+}
 
-  lv2_atom_forge_pop(&ui->forge, &frame);
-  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+static void realloc_pyramid(ScoPyramid *p, uint32_t width) {
+  for (uint32_t k = p->lo; k < PYR_LEVELS; ++k) {
+    realloc_sco_chan(&p->lvl[k], 2 * width);
+  }
+  zero_pyramid(p);
 }
 
-/** notfiy backend that UI is closed */
-static void ui_disable(LV2UI_Handle handle)
+/** add a column of n samples to level k, complete columns
+ * propagate to the next level */
+static void pyr_add(ScoPyramid *p, uint32_t k,
+    float d_min, float d_max, float d_rms, uint32_t n)
 {
-  SiScoUI* ui = (SiScoUI*)handle;
-  ui_state(handle);
+  for (; k < PYR_LEVELS; ++k) {
+    ScoChan *l = &p->lvl[k];
+    if (d_min < l->data_min[l->idx]) { l->data_min[l->idx] = d_min; }
+    if (d_max > l->data_max[l->idx]) { l->data_max[l->idx] = d_max; }
+    l->data_rms[l->idx] += d_rms;
+    l->sub += n;
+    if (l->sub < (1u << k)) {
+      return;
+    }
+    /* keep excess, when fed with columns that are not a power of two */
+    l->sub -= 1u << k;
+    d_min = l->data_min[l->idx];
+    d_max = l->data_max[l->idx];
+    d_rms = l->data_rms[l->idx];
+    n = 1u << k;
+    if (++l->idx >= l->bufsiz) {
+      l->idx = 0;
+    }
+    if (p->fill[k] < l->bufsiz - 1) {
+      ++p->fill[k];
+    }
+    l->data_min[l->idx] =  1.0;
+    l->data_max[l->idx] = -1.0;
+    l->data_rms[l->idx] = 0;
+  }
+}
 
-  uint8_t obj_buf[64];
-  lv2_atom_forge_set_buffer(&ui->forge, obj_buf, 64);
-  LV2_Atom_Forge_Frame frame;
-  lv2_atom_forge_frame_time(&ui->forge, 0);
-  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge, &frame, 1, ui->uris.ui_off);
-  lv2_atom_forge_pop(&ui->forge, &frame);
-  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+/** levels below the one that is fed become stale */
+static void pyr_set_base(ScoPyramid *p, uint32_t k) {
+  if (k == p->base) {
+    return;
+  }
+  for (uint32_t l = p->lo; l < MAX(k, p->base) && l < PYR_LEVELS; ++l) {
+    zero_pyramid_level(p, l);
+  }
+  p->base = k;
 }
 
-/** notify backend that UI is active:
- * request state and enable data-transmission */
-static void ui_enable(LV2UI_Handle handle)
-{
-  SiScoUI* ui = (SiScoUI*)handle;
-  uint8_t obj_buf[64];
-  lv2_atom_forge_set_buffer(&ui->forge, obj_buf, 64);
-  LV2_Atom_Forge_Frame frame;
-  lv2_atom_forge_frame_time(&ui->forge, 0);
-  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge, &frame, 1, ui->uris.ui_on);
-  lv2_atom_forge_pop(&ui->forge, &frame);
-  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+static void pyr_feed_raw(SiScoUI* ui, ScoPyramid *p, const size_t n_elem, float const *data) {
+  ScoChan *l = &p->lvl[p->lo];
+  pyr_set_base(p, p->lo);
+  for (uint32_t i = 0; i < n_elem;) {
+    const uint32_t n = MIN(n_elem - i, (1u << p->lo) - l->sub);
+    float d_min = 1.0, d_max = -1.0, d_rms = 0;
+    ui->reduce(&data[i], n, &d_min, &d_max, &d_rms);
+    pyr_add(p, p->lo, d_min, d_max, d_rms, n);
+    i += n;
+  }
 }
 
-static void apply_state_chn(SiScoUI* ui, LV2_Atom_Vector* vof) {
-  if (vof->atom.type != ui->uris.atom_Float) {
-    return;
+static void pyr_feed_columns(ScoPyramid *p, const uint32_t stride, const size_t n_cols, float const *data) {
+  uint32_t k = p->lo;
+  while ((1u << k) < stride && k + 1 < PYR_LEVELS) {
+    ++k;
   }
-  struct channelstate *cs = (struct channelstate *) LV2_ATOM_BODY(&vof->atom);
-  for (uint32_t c = 0; c < ui->n_channels; ++c) {
-    uint32_t opts = cs[c].opts;
-    if (cs[c].gain < 0) {
+  pyr_set_base(p, k);
+  for (uint32_t i = 0; i < n_cols; ++i, data += 3) {
+    pyr_add(p, k, data[0], data[1], data[2], stride);
+  }
+}
+
+/** n samples of silence, at the level that is currently fed */
+static void pyr_feed_zeros(ScoPyramid *p, uint64_t n_elem) {
+  const uint32_t k = p->base;
+  ScoChan *l = &p->lvl[k];
+  while (n_elem > 0) {
+    const uint32_t n = MIN(n_elem, (1u << k) - l->sub);
+    pyr_add(p, k, 0, 0, 0, n);
+    n_elem -= n;
+  }
+}
+
+/** fill display-buffer for given stride from the pyramid.
+ * The right edge is 'ago' samples before the most recent one,
+ * the next sweep starts at the left.
+ * Columns without data are left blank.
+ */
+static void pyr_render(const ScoPyramid *p, ScoChan *chn, const uint32_t stride, const uint64_t ago) {
+  uint32_t k = p->base;
+  while ((2u << k) <= stride && k + 1 < PYR_LEVELS) {
+    ++k;
+  }
+  const ScoChan *l = &p->lvl[k];
+  const uint32_t fill = p->fill[k];
+  const double bpc = stride / (double)(1u << k); // bins per column
+  /* bin 0 is the most recent complete one */
+  const double boff = ((double)ago - l->sub) / (double)(1u << k);
+
+  zero_sco_chan(chn);
+  for (uint32_t j = chn->bufsiz - 1; j > 0; --j) {
+    const double a0 = boff + (chn->bufsiz - 1 - j) * bpc;
+    const double a1 = a0 + bpc;
+    if (a1 <= 0) {
+      continue;
+    }
+    const uint32_t b0 = MAX(0, floor(a0));
+    const uint32_t b1 = MAX(b0 + 1, ceil(a1));
+    if (b1 > fill) {
+      break;
+    }
+    float d_min = 1.0, d_max = -1.0, d_rms = 0;
+    for (uint32_t b = b0; b < b1; ++b) {
+      const uint32_t pos = (l->idx + l->bufsiz - 1 - b) % l->bufsiz;
+      if (l->data_min[pos] < d_min) { d_min = l->data_min[pos]; }
+      if (l->data_max[pos] > d_max) { d_max = l->data_max[pos]; }
+      d_rms += l->data_rms[pos];
+    }
+    chn->data_min[j] = d_min;
+    chn->data_max[j] = d_max;
+    chn->data_rms[j] = d_rms * bpc / (b1 - b0);
+  }
+  chn->data_min[0] =  1.0;
+  chn->data_max[0] = -1.0;
+}
+#endif
+
+#ifdef WITH_DEEPMEM
+static void free_deep(ScoDeep *d) {
+  if (d->n_chunks == 0) {
+    return;
+  }
+  for (uint32_t i = 0; i < d->n_chunks; ++i) {
+    free(d->chunk[i]);
+  }
+  free(d->chunk);
+  free_pyramid(&d->sum);
+  d->chunk = NULL;
+  d->n_chunks = 0;
+}
+
+/** allocate all chunks up front, port_event() does not allocate */
+static void setup_deep(ScoDeep *d, float rate, float seconds) {
+  free_deep(d);
+  d->rate = rate;
+  d->pos = d->raw_from = 0;
+  if (seconds <= 0 || rate <= 0) {
+    return;
+  }
+  const uint64_t len = ceil(seconds * rate);
+  const uint32_t n_chunks = (len + DEEPMEM_CHUNK - 1) / DEEPMEM_CHUNK;
+  d->chunk = (float**) calloc(n_chunks, sizeof(float*));
+  if (!d->chunk) {
+    return;
+  }
+  d->n_chunks = n_chunks;
+  for (uint32_t i = 0; i < n_chunks; ++i) {
+    d->chunk[i] = (float*) malloc(DEEPMEM_CHUNK * sizeof(float));
+    if (!d->chunk[i]) {
+      fprintf(stderr, "SiSco.lv2 UI: cannot allocate deep memory\n");
+      while (i > 0) { free(d->chunk[--i]); }
+      free(d->chunk);
+      d->chunk = NULL;
+      d->n_chunks = 0;
+      return;
+    }
+  }
+  alloc_pyramid(&d->sum, DEEPMEM_BASE, 8, (uint64_t)d->n_chunks * DEEPMEM_CHUNK);
+}
+
+static void zero_deep(ScoDeep *d) {
+  d->pos = d->raw_from = 0;
+  if (d->n_chunks > 0) {
+    zero_pyramid(&d->sum);
+  }
+}
+
+static inline uint64_t deep_len(const ScoDeep *d) {
+  return (uint64_t)d->n_chunks * DEEPMEM_CHUNK;
+}
+
+static void deep_feed_raw(SiScoUI* ui, ScoDeep *d, size_t n_elem, float const *data) {
+  if (d->n_chunks == 0 || d->rate != ui->rate) {
+    return;
+  }
+  pyr_feed_raw(ui, &d->sum, n_elem, data);
+  while (n_elem > 0) {
+    const uint32_t ci  = (d->pos / DEEPMEM_CHUNK) % d->n_chunks;
+    const uint32_t off = d->pos % DEEPMEM_CHUNK;
+    const uint32_t n   = MIN(n_elem, DEEPMEM_CHUNK - off);
+    memcpy(&d->chunk[ci][off], data, n * sizeof(float));
+    d->pos += n;
+    data += n;
+    n_elem -= n;
+  }
+}
+
+static void deep_feed_zeros(SiScoUI* ui, ScoDeep *d, uint64_t n_elem) {
+  if (d->n_chunks == 0 || d->rate != ui->rate) {
+    return;
+  }
+  pyr_feed_zeros(&d->sum, n_elem);
+  while (n_elem > 0) {
+    const uint32_t ci  = (d->pos / DEEPMEM_CHUNK) % d->n_chunks;
+    const uint32_t off = d->pos % DEEPMEM_CHUNK;
+    const uint32_t n   = MIN(n_elem, DEEPMEM_CHUNK - off);
+    memset(&d->chunk[ci][off], 0, n * sizeof(float));
+    d->pos += n;
+    n_elem -= n;
+  }
+}
+
+static void deep_feed_columns(SiScoUI* ui, ScoDeep *d, const uint32_t stride, const size_t n_cols, float const *data) {
+  if (d->n_chunks == 0 || d->rate != ui->rate) {
+    return;
+  }
+  pyr_feed_columns(&d->sum, stride, n_cols, data);
+  d->pos += (uint64_t)n_cols * stride;
+  d->raw_from = d->pos;
+}
+
+/** render deep-memory, the right edge is 'ago' samples before the
+ * most recent one. Use the summary-index when possible, otherwise
+ * reduce raw data. Either way this is O(display-width).
+ */
+static void deep_render(SiScoUI* ui, const ScoDeep *d, ScoChan *chn, const uint32_t stride, const uint64_t ago) {
+  if (d->n_chunks == 0) {
+    zero_sco_chan(chn);
+    return;
+  }
+  if (stride >= (1u << d->sum.base) || d->raw_from >= d->pos) {
+    pyr_render(&d->sum, chn, stride, ago);
+    return;
+  }
+
+  const uint64_t oldest = MAX(d->raw_from, d->pos > deep_len(d) ? d->pos - deep_len(d) : 0);
+  zero_sco_chan(chn);
+  for (uint32_t j = chn->bufsiz - 1; j > 0; --j) {
+    const uint64_t back = ago + (uint64_t)(chn->bufsiz - j) * stride;
+    if (back > d->pos || d->pos - back < oldest) {
+      break;
+    }
+    uint64_t p = d->pos - back;
+    float d_min = 1.0, d_max = -1.0, d_rms = 0;
+    for (uint32_t n = stride; n > 0;) {
+      const uint32_t ci  = (p / DEEPMEM_CHUNK) % d->n_chunks;
+      const uint32_t off = p % DEEPMEM_CHUNK;
+      const uint32_t nn  = MIN(n, DEEPMEM_CHUNK - off);
+      ui->reduce(&d->chunk[ci][off], nn, &d_min, &d_max, &d_rms);
+      p += nn;
+      n -= nn;
+    }
+    chn->data_min[j] = d_min;
+    chn->data_max[j] = d_max;
+    chn->data_rms[j] = d_rms;
+  }
+  chn->data_min[0] =  1.0;
+  chn->data_max[0] = -1.0;
+}
+
+/** port_event() thread: show deep-memory according to current view */
+static void render_deep_view(SiScoUI* ui) {
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    deep_render(ui, &ui->deep[c], &ui->chn[c], ui->deep_cur.stride, ui->deep_cur.ago);
+    publish_sco_snap(&ui->snap[c], &ui->chn[c]);
+  }
+  ui->stride_vis = ui->deep_cur.stride;
+#ifdef WITH_RESAMPLING
+  ui->src_fact_vis = 1;
+#endif
+  ui->update_ann = true;
+  queue_draw(ui->darea);
+}
+
+/** (re)allocate deep-memory of all channels for the selected depth.
+ * Called when the setting or the sample-rate changes, with the
+ * resize_lock held: port_event() skips data meanwhile.
+ */
+static void setup_deep_memory(SiScoUI* ui) {
+  const float seconds = robtk_select_get_value(ui->sel_deep);
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    setup_deep(&ui->deep[c], ui->rate, seconds);
+  }
+  __atomic_store_n(&ui->deep_dirty, 1, __ATOMIC_RELEASE);
+}
+#endif
+
+#ifdef WITH_XYMODE
+static void alloc_xy(ScoXY *xy) {
+  xy->density = (float*) calloc(XY_SIZE * XY_SIZE, sizeof(float));
+  xy->xbuf = NULL;
+  xy->xlen = xy->xsiz = xy->fill = 0;
+  const int stride = cairo_format_stride_for_width(CAIRO_FORMAT_A8, XY_SIZE);
+  assert(stride == XY_SIZE);
+  for (int i = 0; i < 3; ++i) {
+    xy->pix[i] = (uint8_t*) calloc(XY_SIZE * XY_SIZE, sizeof(uint8_t));
+    xy->sf[i] = cairo_image_surface_create_for_data(xy->pix[i],
+	CAIRO_FORMAT_A8, XY_SIZE, XY_SIZE, stride);
+  }
+  snap_init(&xy->tb);
+}
+
+static void free_xy(ScoXY *xy) {
+  for (int i = 0; i < 3; ++i) {
+    cairo_surface_destroy(xy->sf[i]);
+    free(xy->pix[i]);
+  }
+  free(xy->density);
+  free(xy->xbuf);
+}
+
+/** port_event() thread: decay the density image and publish it */
+static void publish_xy(SiScoUI* ui, ScoXY *xy) {
+  const float tau = XY_PERSISTENCE * ui->rate;
+  /* a trace spanning the image settles at about tau / XY_SIZE hits per pixel */
+  const float scale = 65025.f * XY_SIZE / tau;
+  sco_xy_fade(xy->density, xy->pix[xy->tb.back], XY_SIZE * XY_SIZE,
+      expf(-(float)xy->fill / tau), scale, .5f / scale);
+  xy->fill = 0;
+  snap_publish(&xy->tb);
+}
+
+/** drawing thread: most recently published image */
+static cairo_surface_t * acquire_xy(ScoXY *xy) {
+  if (snap_acquire(&xy->tb)) {
+    cairo_surface_mark_dirty(xy->sf[xy->tb.front]);
+  }
+  return xy->sf[xy->tb.front];
+}
+
+static void zero_xy(ScoXY *xy) {
+  memset(xy->density, 0, XY_SIZE * XY_SIZE * sizeof(float));
+  xy->xlen = 0;
+  xy->fill = 0;
+}
+
+static inline bool display_xy(const SiScoUI* ui) {
+  return ui->display == DM_XY || ui->display == DM_GONIO;
+}
+
+/** square area of the scope used for X/Y display */
+static void xy_area(SiScoUI* ui, int *x0, int *y0, int *side) {
+  *side = MIN(DAWIDTH, DAHEIGHT) - 8;
+  *x0 = (DAWIDTH - *side) / 2;
+  *y0 = (DAHEIGHT - *side) / 2;
+}
+
+/** port_event() thread: channels arrive one after another,
+ * keep the 1st of a pair and splat both when the 2nd arrives.
+ */
+static void xy_feed(SiScoUI* ui, const uint32_t channel, const size_t n_elem, float const * data) {
+  if (channel / 2 >= ui->n_channels / 2) {
+    return;
+  }
+  ScoXY *xy = &ui->xy[channel / 2];
+
+  if ((channel & 1) == 0) {
+    if (n_elem > xy->xsiz) {
+      free(xy->xbuf);
+      xy->xbuf = (float*) malloc(n_elem * sizeof(float));
+      xy->xsiz = xy->xbuf ? n_elem : 0;
+    }
+    if (!xy->xbuf) {
+      xy->xlen = 0;
+      return;
+    }
+    memcpy(xy->xbuf, data, n_elem * sizeof(float));
+    xy->xlen = n_elem;
+    return;
+  }
+
+  if (n_elem == 0 || n_elem != xy->xlen) {
+    /* pair is hidden or incomplete */
+    xy->xlen = 0;
+    return;
+  }
+
+  const float gx = ui->gain[channel - 1];
+  const float gy = ui->gain[channel];
+  float m[4];
+  if (ui->display == DM_GONIO) {
+    m[0] = -gx * M_SQRT1_2; m[1] = gy * M_SQRT1_2;
+    m[2] =  gx * M_SQRT1_2; m[3] = gy * M_SQRT1_2;
+  } else {
+    m[0] = gx; m[1] = 0;
+    m[2] = 0;  m[3] = gy;
+  }
+
+  float *d = xy->density;
+  for (size_t i = 0; i < n_elem; i += XY_CHUNK) {
+    int32_t idx[XY_CHUNK];
+    const uint32_t n = MIN(XY_CHUNK, n_elem - i);
+    sco_xy_index(&xy->xbuf[i], &data[i], n, m, XY_BITS, idx);
+    for (uint32_t k = 0; k < n; ++k) {
+      d[idx[k]] += 1.f;
+    }
+  }
+  xy->xlen = 0;
+
+  xy->fill += n_elem;
+  if (xy->fill >= ui->rate / XY_FPS) {
+    publish_xy(ui, xy);
+    int x0, y0, side;
+    xy_area(ui, &x0, &y0, &side);
+    queue_draw_area(ui->darea, x0, y0, side, side);
+  }
+}
+#endif
+
+#ifdef WITH_PHOSPHOR
+/** color-map: dim channel color -> channel color -> white */
+static void phosphor_lut(ScoPhosphor *ph, const float *col) {
+  ph->lut[0] = 0;
+  for (uint32_t i = 1; i < 256; ++i) {
+    const float t = logf(1 + i) / logf(256);
+    const float a = MIN(1.f, 2.f * t);
+    const float w = MAX(0.f, 2.f * t - 1.f);
+    const uint32_t r = rintf(255.f * a * (col[0] + (1.f - col[0]) * w));
+    const uint32_t g = rintf(255.f * a * (col[1] + (1.f - col[1]) * w));
+    const uint32_t b = rintf(255.f * a * (col[2] + (1.f - col[2]) * w));
+    ph->lut[i] = ((uint32_t)rintf(255.f * a) << 24) | (r << 16) | (g << 8) | b;
+  }
+}
+
+static void zero_phosphor(ScoPhosphor *ph) {
+  memset(ph->hits, 0, ph->width * PH_BINS * sizeof(uint16_t));
+  ph->fill = 0;
+}
+
+static void alloc_phosphor(ScoPhosphor *ph, uint32_t width) {
+  const int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+  assert(stride == (int)(width * sizeof(uint32_t)));
+  ph->width = width;
+  ph->hits = (uint16_t*) calloc(width * PH_BINS, sizeof(uint16_t));
+  for (int i = 0; i < 3; ++i) {
+    ph->pix[i] = (uint32_t*) calloc(width * PH_BINS, sizeof(uint32_t));
+    ph->sf[i] = cairo_image_surface_create_for_data((unsigned char*) ph->pix[i],
+	CAIRO_FORMAT_ARGB32, width, PH_BINS, stride);
+  }
+  snap_init(&ph->tb);
+  ph->gain = 0;
+  ph->stride = 0;
+  ph->fill = 0;
+}
+
+static void free_phosphor(ScoPhosphor *ph) {
+  for (int i = 0; i < 3; ++i) {
+    cairo_surface_destroy(ph->sf[i]);
+    free(ph->pix[i]);
+  }
+  free(ph->hits);
+}
+
+static void realloc_phosphor(ScoPhosphor *ph, uint32_t width) {
+  free_phosphor(ph);
+  alloc_phosphor(ph, width);
+}
+
+/** port_event() thread: start over when the mapping changes */
+static void setup_phosphor(SiScoUI* ui, const uint32_t channel) {
+  ScoPhosphor *ph = &ui->ph[channel];
+  if (ph->gain == ui->gain[channel] && ph->stride == ui->stride) {
+    return;
+  }
+  zero_phosphor(ph);
+  ph->gain = ui->gain[channel];
+  ph->stride = ui->stride;
+  ph->weight = MAX(1, PH_HITS / ui->stride);
+}
+
+static inline void ph_decay_column(ScoPhosphor *ph, const uint32_t col) {
+  uint16_t *h = &ph->hits[col * PH_BINS];
+  for (uint32_t b = 0; b < PH_BINS; ++b) {
+    h[b] -= h[b] >> PH_DECAY;
+  }
+}
+
+static inline void ph_hit(uint16_t *h, const uint32_t w) {
+  const uint32_t v = *h + w;
+  *h = v > 0xffff ? 0xffff : v;
+}
+
+/** port_event() thread: add samples, starting at column 'idx', sample 'sub'
+ * (the position of the display-buffer before process_channel()) */
+static void ph_feed(SiScoUI* ui, const uint32_t channel,
+    uint32_t idx, uint32_t sub, const size_t n_elem, float const *data)
+{
+  ScoPhosphor *ph = &ui->ph[channel];
+  const uint32_t stride = ui->stride;
+  const uint32_t w = ph->weight;
+  const float scale = .5f * PH_BINS * ui->gain[channel] / PH_RANGE;
+  const float ctr = .5f * PH_BINS;
+
+  for (size_t i = 0; i < n_elem;) {
+    const uint32_t n = sub < stride ? MIN(n_elem - i, stride - sub) : 0;
+    if (sub == 0 && n > 0) {
+      ph_decay_column(ph, idx);
+    }
+    uint16_t *h = &ph->hits[idx * PH_BINS];
+    for (uint32_t k = 0; k < n; ++k) {
+      const float v = ctr + scale * data[i + k];
+      if (v >= 0 && v < PH_BINS) {
+	ph_hit(&h[(uint32_t)v], w);
+      }
+    }
+    i += n;
+    sub += n;
+    if (sub >= stride) {
+      sub = 0;
+      if (++idx >= ph->width) {
+	idx = 0;
+      }
+    }
+  }
+}
+
+#ifdef WITH_TRIGGER
+/** port_event() thread: add columns copied from the trigger-buffer,
+ * only their min/max is known, the weight is spread evenly */
+static void ph_feed_columns(SiScoUI* ui, const uint32_t channel, const ScoChan *chn, const uint32_t n_cols) {
+  ScoPhosphor *ph = &ui->ph[channel];
+  const float scale = .5f * PH_BINS * ui->gain[channel] / PH_RANGE;
+  const float ctr = .5f * PH_BINS;
+  for (uint32_t i = 0; i < n_cols && i < ph->width; ++i) {
+    ph_decay_column(ph, i);
+    if (chn->data_min[i] > chn->data_max[i]) {
+      continue;
+    }
+    float v0 = ctr + scale * chn->data_min[i];
+    float v1 = ctr + scale * chn->data_max[i];
+    if (v0 > v1) {
+      const float t = v0; v0 = v1; v1 = t;
+    }
+    const int32_t b0 = MAX(0, (int32_t) v0);
+    const int32_t b1 = MIN(PH_BINS - 1, (int32_t) v1);
+    if (b0 > b1) {
+      continue;
+    }
+    const uint32_t w = MAX(1, PH_HITS / (b1 - b0 + 1));
+    uint16_t *h = &ph->hits[i * PH_BINS];
+    for (int32_t b = b0; b <= b1; ++b) {
+      ph_hit(&h[b], w);
+    }
+  }
+}
+#endif
+
+/** port_event() thread: render the histogram through the color-map
+ * into the back-buffer and publish it. Rows are flipped: up is positive */
+static void publish_phosphor(ScoPhosphor *ph) {
+  uint32_t *pix = ph->pix[ph->tb.back];
+  const uint32_t width = ph->width;
+  for (uint32_t x = 0; x < width; ++x) {
+    const uint16_t *h = &ph->hits[x * PH_BINS];
+    uint32_t *p = &pix[(PH_BINS - 1) * width + x];
+    for (uint32_t b = 0; b < PH_BINS; ++b, p -= width) {
+      *p = ph->lut[MIN(255, h[b] >> PH_SHIFT)];
+    }
+  }
+  ph->fill = 0;
+  snap_publish(&ph->tb);
+}
+
+/** drawing thread: most recently published image */
+static cairo_surface_t * acquire_phosphor(ScoPhosphor *ph) {
+  if (snap_acquire(&ph->tb)) {
+    cairo_surface_mark_dirty(ph->sf[ph->tb.front]);
+  }
+  return ph->sf[ph->tb.front];
+}
+#endif
+
+#ifdef WITH_SPECTRUM
+static void alloc_spec(ScoSpec *sp, uint32_t width) {
+  sp->ring = (float*) calloc(SPEC_MAX, sizeof(float));
+  sp->pwr  = (float*) calloc(SPEC_MAX / 2 + 1, sizeof(float));
+  sp->peak = (float*) calloc(width, sizeof(float));
+  for (int i = 0; i < 3; ++i) {
+    sp->col[i] = (float*) calloc(2 * width, sizeof(float));
+    for (uint32_t x = 0; x < 2 * width; ++x) {
+      sp->col[i][x] = -SPEC_DBRANGE;
+    }
+  }
+  sp->width = width;
+  sp->pos = sp->hop = sp->fill = 0;
+  sp->reset = true;
+  snap_init(&sp->tb);
+}
+
+static void free_spec(ScoSpec *sp) {
+  for (int i = 0; i < 3; ++i) {
+    free(sp->col[i]);
+  }
+  free(sp->peak);
+  free(sp->pwr);
+  free(sp->ring);
+}
+
+static void realloc_spec(ScoSpec *sp, uint32_t width) {
+  free_spec(sp);
+  alloc_spec(sp, width);
+}
+
+static inline float spec_freq(SiScoUI* ui, const float x) {
+  return SPEC_FMIN * powf(.5f * ui->rate / SPEC_FMIN, x / (DAWIDTH - 1.f));
+}
+
+static inline float spec_xpos(SiScoUI* ui, const float freq) {
+  return (DAWIDTH - 1.f) * logf(freq / SPEC_FMIN) / logf(.5f * ui->rate / SPEC_FMIN);
+}
+
+static inline float spec_ypos(SiScoUI* ui, const float db) {
+  return rintf(DAHEIGHT * MIN(1.f, MAX(0.f, -db / SPEC_DBRANGE))) - .5f;
+}
+
+/** port_event() thread, in sync with the 1st channel: follow the settings,
+ * (re)build the plan only when the size changes */
+static void setup_spectrum(SiScoUI* ui) {
+  const uint32_t size = robtk_select_get_value(ui->sel_fft_size);
+  const bool peak = robtk_cbtn_get_active(ui->btn_fft_peak);
+  bool reset = peak != ui->fft_peak;
+
+  ui->fft_alpha = robtk_select_get_value(ui->sel_fft_avg);
+  ui->fft_peak = peak;
+
+  if (size != ui->fft_size) {
+    sco_fft_free(&ui->fft);
+    free(ui->fft_win);
+    free(ui->fft_in);
+    ui->fft_win = (float*) malloc(size * sizeof(float));
+    ui->fft_in  = (float*) malloc(size * sizeof(float));
+    ui->fft_size = 0; // off, until allocated
+    if (!ui->fft_win || !ui->fft_in || !sco_fft_init(&ui->fft, size)) {
+      return;
+    }
+    double sum = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+      ui->fft_win[i] = .5f - .5f * cos(2.0 * M_PI * i / size);
+      sum += ui->fft_win[i];
+    }
+    ui->fft_norm = 4.0 / (sum * sum);
+    ui->fft_size = size;
+    ui->fft_rate = 0;
+    reset = true;
+  }
+
+  if (ui->fft_rate != ui->rate || ui->fft_width != DAWIDTH) {
+    free(ui->fft_col);
+    ui->fft_col = (uint32_t*) malloc((DAWIDTH + 1) * sizeof(uint32_t));
+    if (!ui->fft_col) {
+      ui->fft_size = 0;
+      return;
+    }
+    for (uint32_t x = 0; x <= DAWIDTH; ++x) {
+      const float bin = spec_freq(ui, x - .5f) * size / ui->rate;
+      ui->fft_col[x] = MIN(size / 2, (uint32_t) ceilf(MAX(0.f, bin)));
+    }
+    ui->fft_rate = ui->rate;
+    ui->fft_width = DAWIDTH;
+    reset = true;
+  }
+
+  /* overlap: at least 50%, more if needed to keep up with SPEC_FPS */
+  ui->fft_hop = MAX(size / 8, MIN(size / 2, (uint32_t)(ui->rate / SPEC_FPS)));
+
+  if (reset) {
+    for (uint32_t c = 0; c < ui->n_channels; ++c) {
+      ui->spec[c].reset = true;
+    }
+  }
+}
+
+/** window the last fft_size samples and add them to the average */
+static void spec_transform(SiScoUI* ui, ScoSpec *sp) {
+  const uint32_t size = ui->fft_size;
+  const uint32_t start = sp->pos - size;
+  for (uint32_t i = 0; i < size; ++i) {
+    ui->fft_in[i] = sp->ring[(start + i) & (SPEC_MAX - 1)] * ui->fft_win[i];
+  }
+  sco_fft_forward(&ui->fft, ui->fft_in);
+  sco_power_avg(ui->fft.re, ui->fft.im, sp->pwr, size / 2 + 1, sp->reset ? 1.f : ui->fft_alpha);
+  if (sp->reset) {
+    for (uint32_t x = 0; x < sp->width; ++x) {
+      sp->peak[x] = -SPEC_DBRANGE;
+    }
+    sp->reset = false;
+  }
+}
+
+/** reduce bins to display-columns and publish them */
+static void publish_spec(SiScoUI* ui, ScoSpec *sp) {
+  float *col = sp->col[sp->tb.back];
+  const uint32_t width = MIN(sp->width, ui->fft_width);
+  for (uint32_t x = 0; x < width; ++x) {
+    const uint32_t k0 = ui->fft_col[x];
+    const uint32_t k1 = ui->fft_col[x + 1];
+    float p = sp->pwr[k0];
+    for (uint32_t k = k0 + 1; k < k1; ++k) {
+      p = MAX(p, sp->pwr[k]);
+    }
+    float db = 10.f * log10f(p * ui->fft_norm);
+    if (!(db > -SPEC_DBRANGE)) {
+      db = -SPEC_DBRANGE; // also NaN
+    }
+    if (db > sp->peak[x]) {
+      sp->peak[x] = db;
+    }
+    col[2 * x] = db;
+    col[2 * x + 1] = ui->fft_peak ? sp->peak[x] : db;
+  }
+  sp->fill = 0;
+  snap_publish(&sp->tb);
+}
+
+/** drawing thread: most recently published columns */
+static const float * acquire_spec(ScoSpec *sp) {
+  snap_acquire(&sp->tb);
+  return sp->col[sp->tb.front];
+}
+
+/** port_event() thread: add samples, transform every fft_hop */
+static void spec_feed(SiScoUI* ui, const uint32_t channel, const size_t n_elem, float const * data) {
+  ScoSpec *sp = &ui->spec[channel];
+  for (size_t i = 0; i < n_elem;) {
+    const uint32_t off = sp->pos & (SPEC_MAX - 1);
+    const uint32_t n = MIN(MIN(n_elem - i, ui->fft_hop - sp->hop), SPEC_MAX - off);
+    memcpy(&sp->ring[off], &data[i], n * sizeof(float));
+    sp->pos += n;
+    sp->hop += n;
+    i += n;
+    if (sp->hop >= ui->fft_hop) {
+      sp->hop = 0;
+      spec_transform(ui, sp);
+    }
+  }
+  sp->fill += n_elem;
+  if (sp->fill >= ui->rate / SPEC_FPS && n_elem > 0) {
+    publish_spec(ui, sp);
+    queue_draw_area(ui->darea, 0, 0, DAWIDTH, DAHEIGHT);
+  }
+}
+#endif
+
+#ifdef WITH_SWEEPAVG
+/** continuous trigger: average the sweeps rather than replace them */
+static inline bool sweep_averaging(SiScoUI* ui) {
+  return ui->avg_n > 0
+    && ui->trigger_cfg_mode == 2
+    && ui->trigger_state != TS_DISABLED
+    && (ui->avg_count > 0 || ui->avg_held);
+}
+
+static void reset_sweep_average(SiScoUI* ui) {
+  ui->avg_count = 0;
+  ui->avg_held = false;
+}
+
+/** port_event() thread, in sync with the 1st channel:
+ * all channels completed a sweep, add it to the average.
+ * Linear averages sum blocks of avg_n sweeps, the last complete
+ * block is shown while the next one is collected.
+ * Exponential averages converge with 1/n until n reaches avg_n.
+ */
+static void sweep_average(SiScoUI* ui) {
+  if (ui->avg_n == 0 || ui->trigger_cfg_mode != 2) {
+    return;
+  }
+  const uint32_t count = ++ui->avg_count;
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    ScoChan *chn = &ui->chn[c];
+    ScoChan *sum = &ui->avg_sum[c];
+    ScoChan *avg = &ui->avg[c];
+    const uint32_t n = MIN(chn->bufsiz, avg->bufsiz);
+
+    if (ui->avg_exp) {
+      const float alpha = 1.f / MIN(count, ui->avg_n);
+      sco_blend(chn->data_min, avg->data_min, n, alpha);
+      sco_blend(chn->data_max, avg->data_max, n, alpha);
+      sco_blend(chn->data_rms, avg->data_rms, n, alpha);
+    } else {
+      if (count == 1) {
+	zero_sco_chan(sum);
+      }
+      sco_accumulate(chn->data_min, sum->data_min, n);
+      sco_accumulate(chn->data_max, sum->data_max, n);
+      sco_accumulate(chn->data_rms, sum->data_rms, n);
+      if (count == ui->avg_n || !ui->avg_held) {
+	const float gain = 1.f / count;
+	sco_scale(sum->data_min, avg->data_min, n, gain);
+	sco_scale(sum->data_max, avg->data_max, n, gain);
+	sco_scale(sum->data_rms, avg->data_rms, n, gain);
+      }
+    }
+    avg->idx = chn->idx;
+    avg->sub = 0;
+  }
+  if (!ui->avg_exp && count == ui->avg_n) {
+    ui->avg_count = 0;
+    ui->avg_held = true;
+  }
+  queue_draw(ui->darea);
+}
+#endif
+
+#ifdef WITH_TRIGGER
+static inline void setup_trigger(SiScoUI* ui) {
+  ui->trigger_state_n = TS_INITIALIZING;
+}
+static inline void next_tigger_state(SiScoUI* ui, enum TriggerState next) {
+  if (ui->trigger_state_n == TS_DISABLED || ui->trigger_state == TS_DISABLED) return;
+  ui->trigger_state_n = next;
+}
+/** the capture is complete and stays on screen until re-armed */
+static inline bool trigger_held(SiScoUI* ui) {
+  return ui->trigger_state == TS_END
+    && (ui->trigger_cfg_mode == 1 || ui->trigger_cfg_mode == 3);
+}
+#endif
+
+
+/******************************************************************************
+ * Communication with DSP backend -- send/receive settings
+ */
+
+
+/** send current settings to backend */
+static void ui_state(LV2UI_Handle handle)
+{
+  SiScoUI* ui = (SiScoUI*)handle;
+  uint8_t obj_buf[4096];
+  struct channelstate cs[MAX_CHANNELS];
+  const int32_t grid = robtk_select_get_item(ui->sel_speed);
+  int32_t misc = 0;
+
+  if (robtk_cbtn_get_active(ui->btn_latch)) {
+    misc |= 1;
+  }
+  if (robtk_cbtn_get_active(ui->btn_align)) {
+    misc |= 2;
+  }
+  misc |= ((int32_t)robtk_select_get_value(ui->sel_display) & 7) << 2;
+#ifdef WITH_SPECTRUM
+  /* 0: not set, keep the default */
+  misc |= (robtk_select_get_item(ui->sel_fft_size) + 1) << 5;
+  misc |= (robtk_select_get_item(ui->sel_fft_avg) + 1) << 8;
+#endif
+#ifdef WITH_ACQMODES
+  misc |= ((int32_t)robtk_select_get_value(ui->sel_acq) & 3) << 10;
+#endif
+#ifdef WITH_SWEEPAVG
+  misc |= (robtk_select_get_item(ui->sel_trigger_avg) & 15) << 12;
+#endif
+#ifdef WITH_SEGMENTS
+  misc |= (robtk_select_get_item(ui->sel_seg_num) + 1) << 16;
+#endif
+#ifdef WITH_DEEPMEM
+  misc |= (robtk_select_get_item(ui->sel_deep) & 3) << 19;
+#endif
+
+#ifdef WITH_TRIGGER
+  struct triggerstate ts;
+  ts.mode = robtk_select_get_item(ui->sel_trigger_mode);
+  ts.type = robtk_select_get_item(ui->sel_trigger_type);
+  ts.xpos = robtk_spin_get_value(ui->spb_trigger_pos);
+  ts.hold = robtk_spin_get_value(ui->spb_trigger_hld);
+  ts.level= robtk_spin_get_value(ui->spb_trigger_lvl);
+  ts.kind = robtk_select_get_item(ui->sel_trigger_kind);
+  ts.param= robtk_spin_get_value(ui->spb_trigger_par);
+  ts.hyst = robtk_spin_get_value(ui->spb_trigger_hys);
+  ts.hfrej= robtk_select_get_value(ui->sel_trigger_hfr);
+#endif
+
+#ifdef WITH_MARKERS
+  struct cursorstate ms;
+  ms.xpos[0] = robtk_dial_get_value(ui->spb_marker_x0);
+  ms.xpos[1] = robtk_dial_get_value(ui->spb_marker_x1);
+  ms.chn[0] = robtk_spin_get_value(ui->spb_marker_c0);
+  ms.chn[1] = robtk_spin_get_value(ui->spb_marker_c1);
+#endif
+
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    uint32_t opts = 0;
+    if (robtk_cbtn_get_active(ui->btn_chn[c])) opts |= 1;
+#ifdef WITH_MARKERS
+    opts |= (robtk_mbtn_get_active(ui->btn_ann[c])) << 1;
+#endif
+    cs[c].gain = db_to_coefficient(robtk_dial_get_value(ui->spb_amp[c]));
+    if (robtk_dial_get_state(ui->spb_amp[c]) == 1) cs[c].gain *= -1;
+    cs[c].xoff = robtk_dial_get_value(ui->spb_xoff[c]);
+    cs[c].yoff = robtk_dial_get_value(ui->spb_yoff[c]);
+    cs[c].opts = opts;
+  }
+
+  /* widget callbacks also fire while port_event() applies the
+   * backend's state: forge on a copy, not the shared ui->forge */
+  LV2_Atom_Forge forge = ui->forge;
+  lv2_atom_forge_set_buffer(&forge, obj_buf, 1024);
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(&forge, 0);
+  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&forge, &frame, 1, ui->uris.ui_state);
+
+
+  lv2_atom_forge_property_head(&forge, ui->uris.ui_state_grid, 0);
+  lv2_atom_forge_int(&forge, grid);
+
+  lv2_atom_forge_property_head(&forge, ui->uris.ui_state_misc, 0);
+  lv2_atom_forge_int(&forge, misc);
+
+#ifdef WITH_TRIGGER
+  lv2_atom_forge_property_head(&forge, ui->uris.ui_state_trig, 0);
+  lv2_atom_forge_vector(&forge, sizeof(float), ui->uris.atom_Float,
+      sizeof(struct triggerstate) / sizeof(float), &ts);
+#endif
+#ifdef WITH_MARKERS
+  lv2_atom_forge_property_head(&forge, ui->uris.ui_state_curs, 0);
+  lv2_atom_forge_vector(&forge, sizeof(int32_t), ui->uris.atom_Int,
+      sizeof(struct cursorstate) / sizeof(int32_t), &ms);
+#endif
+  lv2_atom_forge_property_head(&forge, ui->uris.ui_state_chn, 0);
+  lv2_atom_forge_vector(&forge, sizeof(float), ui->uris.atom_Float,
+      ui->n_channels * sizeof(struct channelstate) / sizeof(float), cs);
+
+  lv2_atom_forge_pop(&forge, &frame);
+  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+}
+
+/** notfiy backend that UI is closed */
+static void ui_disable(LV2UI_Handle handle)
+{
+  SiScoUI* ui = (SiScoUI*)handle;
+  ui_state(handle);
+
+  uint8_t obj_buf[64];
+  lv2_atom_forge_set_buffer(&ui->forge, obj_buf, 64);
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(&ui->forge, 0);
+  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge, &frame, 1, ui->uris.ui_off);
+  lv2_atom_forge_pop(&ui->forge, &frame);
+  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+}
+
+/** notify backend that UI is active:
+ * request state and enable data-transmission */
+static void ui_enable(LV2UI_Handle handle)
+{
+  SiScoUI* ui = (SiScoUI*)handle;
+#ifdef WITH_DECIMATION
+  ui->decim_stride = 0; // backend resets to raw audio
+#endif
+  ui->want = ~0; // backend resets to all channels
+#ifdef WITH_PROFILING
+  ui->prof_dsp = false;
+#endif
+  for (uint32_t c = 0; c < MAX_CHANNELS; ++c) {
+    ui->rx_valid[c] = false;
+  }
+#ifdef WITH_DSP_TRIGGER
+  ui->trigger_dsp = false;
+  ui->trigger_abort = false;
+  ui->trigger_dsp_fail = false;
+#endif
+  uint8_t obj_buf[64];
+  lv2_atom_forge_set_buffer(&ui->forge, obj_buf, 64);
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(&ui->forge, 0);
+  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge, &frame, 1, ui->uris.ui_on);
+  lv2_atom_forge_pop(&ui->forge, &frame);
+  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+}
+
+/** tell the backend which channels to send, bit 'n' for channel 'n' */
+static void ui_request_channels(SiScoUI* ui, uint32_t want)
+{
+  uint8_t obj_buf[64];
+  ui->want = want;
+  lv2_atom_forge_set_buffer(&ui->forge_pe, obj_buf, 64);
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(&ui->forge_pe, 0);
+  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge_pe, &frame, 1, ui->uris.ui_state);
+  lv2_atom_forge_property_head(&ui->forge_pe, ui->uris.ui_state_want, 0);
+  lv2_atom_forge_int(&ui->forge_pe, want);
+  lv2_atom_forge_pop(&ui->forge_pe, &frame);
+  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+}
+
+#ifdef WITH_DECIMATION
+/** ask the backend to send min/max/rms columns
+ * of given stride instead of raw audio (0: raw) */
+static void ui_request_decimation(SiScoUI* ui, uint32_t stride)
+{
+  uint8_t obj_buf[64];
+  ui->decim_stride = stride;
+  lv2_atom_forge_set_buffer(&ui->forge_pe, obj_buf, 64);
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(&ui->forge_pe, 0);
+  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge_pe, &frame, 1, ui->uris.ui_state);
+  lv2_atom_forge_property_head(&ui->forge_pe, ui->uris.ui_state_stride, 0);
+  lv2_atom_forge_int(&ui->forge_pe, stride);
+  lv2_atom_forge_pop(&ui->forge_pe, &frame);
+  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+}
+#endif
+
+#ifdef WITH_PROFILING
+/** ask the backend to report the duration of run() */
+static void ui_request_profile(SiScoUI* ui, bool enable)
+{
+  uint8_t obj_buf[64];
+  ui->prof_dsp = enable;
+  lv2_atom_forge_set_buffer(&ui->forge_pe, obj_buf, 64);
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(&ui->forge_pe, 0);
+  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge_pe, &frame, 1, ui->uris.ui_state);
+  lv2_atom_forge_property_head(&ui->forge_pe, ui->uris.ui_state_prof, 0);
+  lv2_atom_forge_int(&ui->forge_pe, enable ? 1 : 0);
+  lv2_atom_forge_pop(&ui->forge_pe, &frame);
+  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+}
+#endif
+
+#ifdef WITH_DSP_TRIGGER
+/** arm the backend's trigger with a window of pre + post samples,
+ * the trigger-point is at 'pre'. pre + post == 0 disarms it */
+static void ui_request_trigger(SiScoUI* ui, uint32_t pre, uint32_t post)
+{
+  uint8_t obj_buf[256];
+  const int32_t tarm[2] = { (int32_t)pre, (int32_t)post };
+  struct triggerstate ts;
+  ts.mode = ui->trigger_cfg_mode;
+  ts.type = ui->trigger_cfg_channel << 1 | ui->trigger_cfg_type;
+  ts.xpos = robtk_spin_get_value(ui->spb_trigger_pos);
+  ts.hold = robtk_spin_get_value(ui->spb_trigger_hld);
+  ts.level= ui->trigger_cfg_lvl;
+  ts.kind = ui->trigger_cfg_kind;
+  ts.param= ui->trigger_cfg_par;
+  ts.hyst = ui->trigger_cfg_hys;
+  ts.hfrej= ui->trigger_cfg_hfr;
+
+  ui->trigger_dsp = pre + post > 0;
+  ui->trigger_nowin = 0;
+  lv2_atom_forge_set_buffer(&ui->forge_pe, obj_buf, 256);
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(&ui->forge_pe, 0);
+  LV2_Atom* msg = (LV2_Atom*)x_forge_object(&ui->forge_pe, &frame, 1, ui->uris.ui_state);
+  lv2_atom_forge_property_head(&ui->forge_pe, ui->uris.ui_state_trig, 0);
+  lv2_atom_forge_vector(&ui->forge_pe, sizeof(float), ui->uris.atom_Float,
+      sizeof(struct triggerstate) / sizeof(float), &ts);
+  lv2_atom_forge_property_head(&ui->forge_pe, ui->uris.ui_state_tarm, 0);
+  lv2_atom_forge_vector(&ui->forge_pe, sizeof(int32_t), ui->uris.atom_Int, 2, tarm);
+  lv2_atom_forge_pop(&ui->forge_pe, &frame);
+  ui->write(ui->controller, 0, lv2_atom_total_size(msg), ui->uris.atom_eventTransfer, msg);
+}
+#endif
+
+static void apply_state_chn(SiScoUI* ui, LV2_Atom_Vector* vof) {
+  if (vof->atom.type != ui->uris.atom_Float) {
+    return;
+  }
+  struct channelstate *cs = (struct channelstate *) LV2_ATOM_BODY(&vof->atom);
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    uint32_t opts = cs[c].opts;
+    if (cs[c].gain < 0) {
       robtk_dial_set_state(ui->spb_amp[c], 1);
       robtk_dial_set_value(ui->spb_amp[c], coefficient_to_dB(-cs[c].gain));
     } else {
@@ -501,8 +2080,9 @@ static void apply_state_chn(SiScoUI* ui, LV2_Atom_Vector* vof) {
 }
 
 #ifdef WITH_TRIGGER
-static void apply_state_trig(SiScoUI* ui, LV2_Atom_Vector* vof) {
-  if (vof->atom.type != ui->uris.atom_Float) {
+/** len: size of the vector's elements, older states lack the later members */
+static void apply_state_trig(SiScoUI* ui, LV2_Atom_Vector* vof, const size_t len) {
+  if (vof->atom.type != ui->uris.atom_Float || len < TRIGGERSTATE_MIN_SIZE) {
     return;
   }
   struct triggerstate *ts = (struct triggerstate *) LV2_ATOM_BODY(&vof->atom);
@@ -510,6 +2090,14 @@ static void apply_state_trig(SiScoUI* ui, LV2_Atom_Vector* vof) {
   robtk_spin_set_value(ui->spb_trigger_pos, ts->xpos);
   robtk_spin_set_value(ui->spb_trigger_hld, ts->hold);
   robtk_select_set_item(ui->sel_trigger_type, ts->type);
+  if (len >= offsetof(struct triggerstate, hyst)) {
+    robtk_select_set_item(ui->sel_trigger_kind, ts->kind);
+    robtk_spin_set_value(ui->spb_trigger_par, ts->param);
+  }
+  if (len >= sizeof(struct triggerstate)) {
+    robtk_spin_set_value(ui->spb_trigger_hys, ts->hyst);
+    robtk_select_set_value(ui->sel_trigger_hfr, ts->hfrej);
+  }
   robtk_select_set_item(ui->sel_trigger_mode, ts->mode);
 }
 #endif
@@ -547,6 +2135,35 @@ static bool solidwave_btn_callback (RobWidget *widget, void* data)
 }
 #endif
 
+#ifdef WITH_PROFILING
+static bool profile_btn_callback (RobWidget *widget, void* data)
+{
+  SiScoUI* ui = (SiScoUI*) data;
+  const bool en = robtk_cbtn_get_active(ui->btn_profile);
+  if (en && !ui->profile) {
+    memset(ui->prof, 0, sizeof(ui->prof));
+    ui->prof_since = prof_now();
+    ui->prof_csv = 0;
+  }
+  ui->profile = en;
+  queue_draw(ui->darea);
+  return TRUE;
+}
+#endif
+
+#ifdef WITH_SPECTRUM
+static bool display_sel_callback (RobWidget *widget, void* data)
+{
+  SiScoUI* ui = (SiScoUI*) data;
+  const bool spectrum = robtk_select_get_value(ui->sel_display) == DM_SPECTRUM;
+  robtk_select_set_sensitive(ui->sel_fft_size, spectrum);
+  robtk_select_set_sensitive(ui->sel_fft_avg, spectrum);
+  robtk_cbtn_set_sensitive(ui->btn_fft_peak, spectrum);
+  ui_state(data);
+  return TRUE;
+}
+#endif
+
 static bool latch_btn_callback (RobWidget *widget, void* data)
 {
   SiScoUI* ui = (SiScoUI*) data;
@@ -577,7 +2194,7 @@ static bool mrk_changed (RobWidget *widget, void* data)
   SiScoUI* ui = (SiScoUI*) data;
   if (ui->paused
 #ifdef WITH_TRIGGER
-      || (ui->trigger_state == TS_END && ui->trigger_cfg_mode == 1)
+      || trigger_held(ui)
 #endif
       ) {
     queue_draw(ui->darea);
@@ -590,7 +2207,7 @@ static RobWidget* mouse_down(RobWidget* handle, RobTkBtnEvent *ev) {
   SiScoUI* ui = (SiScoUI*) GET_HANDLE(handle);
   if (!ui->paused
 #ifdef WITH_TRIGGER
-      && !(ui->trigger_state == TS_END && ui->trigger_cfg_mode == 1)
+      && !trigger_held(ui)
 #endif
       ) {
 #if 0 // toggle sidebar on righ-click
@@ -628,7 +2245,7 @@ static RobWidget* mouse_move(RobWidget* handle, RobTkBtnEvent *ev) {
   SiScoUI* ui = (SiScoUI*) GET_HANDLE(handle);
   if (!ui->paused
 #ifdef WITH_TRIGGER
-      && !(ui->trigger_state == TS_END && ui->trigger_cfg_mode == 1)
+      && !trigger_held(ui)
 #endif
       ) return NULL;
 
@@ -646,11 +2263,103 @@ static RobWidget* mouse_move(RobWidget* handle, RobTkBtnEvent *ev) {
 }
 #endif
 
+#ifdef WITH_DEEPMEM
+static bool deep_sel_callback (RobWidget *widget, void* data)
+{
+  SiScoUI* ui = (SiScoUI*) data;
+  pthread_mutex_lock(&ui->resize_lock);
+  setup_deep_memory(ui);
+  pthread_mutex_unlock(&ui->resize_lock);
+  ui_state(data);
+  return TRUE;
+}
+
+/** pan/zoom deep-memory while paused:
+ * scroll: zoom around the mouse-pointer, shift+scroll, left/right: pan
+ */
+static RobWidget* mouse_scroll(RobWidget* handle, RobTkBtnEvent *ev) {
+  SiScoUI* ui = (SiScoUI*) GET_HANDLE(handle);
+  if (!ui->paused
+#ifdef WITH_TRIGGER
+      || ui->trigger_cfg_mode != 0
+#endif
+      ) return NULL;
+
+  /* data is not modified while paused */
+  const ScoDeep *d = &ui->deep[0];
+  if (d->n_chunks == 0) {
+    return NULL;
+  }
+
+  /* start at the current time-scale, after every resume */
+  ScoDeepView *v = &ui->deep_gui;
+  const int epoch = __atomic_load_n(&ui->deep_epoch, __ATOMIC_ACQUIRE);
+  if (v->stride == 0 || v->epoch != epoch) {
+    v->epoch = epoch;
+    v->stride = ui->stride;
+#ifdef WITH_RESAMPLING
+    v->stride = MAX(1, ui->stride / ui->src_fact);
+#endif
+    v->ago = 0;
+  }
+
+  const uint64_t avail = MIN(d->pos, deep_len(d));
+  const uint32_t x = MIN(MAX(0, ev->x), DAWIDTH - 1);
+  const uint64_t x_ago = v->ago + (uint64_t)(DAWIDTH - 1 - x) * v->stride;
+  const uint64_t pan = MAX(1, DAWIDTH / 8) * (uint64_t)v->stride;
+  uint32_t stride = v->stride;
+  uint64_t ago = v->ago;
+  bool zoom = false;
+
+  int dir = ev->direction;
+  if (ev->state & ROBTK_MOD_SHIFT) {
+    if (dir == ROBTK_SCROLL_UP) dir = ROBTK_SCROLL_RIGHT;
+    if (dir == ROBTK_SCROLL_DOWN) dir = ROBTK_SCROLL_LEFT;
+  }
+
+  switch (dir) {
+    case ROBTK_SCROLL_UP:
+      stride = MAX(1, stride / 2);
+      zoom = true;
+      break;
+    case ROBTK_SCROLL_DOWN:
+      if ((uint64_t)stride * 2 * DAWIDTH <= avail && stride < (1u << (PYR_LEVELS - 1))) {
+	stride *= 2;
+      }
+      zoom = true;
+      break;
+    case ROBTK_SCROLL_LEFT:
+      ago += pan;
+      break;
+    case ROBTK_SCROLL_RIGHT:
+      ago = ago > pan ? ago - pan : 0;
+      break;
+    default:
+      return NULL;
+  }
+
+  if (zoom) {
+    /* keep the sample under the mouse-pointer in place */
+    const uint64_t dx = (uint64_t)(DAWIDTH - 1 - x) * stride;
+    ago = x_ago > dx ? x_ago - dx : 0;
+  }
+  if (ago + (uint64_t)DAWIDTH * stride > avail) {
+    ago = avail > (uint64_t)DAWIDTH * stride ? avail - (uint64_t)DAWIDTH * stride : 0;
+  }
+
+  v->stride = stride;
+  v->ago = ago;
+  ui->deep_req[ui->deep_tb.back] = *v;
+  snap_publish(&ui->deep_tb);
+  return handle;
+}
+#endif
+
 #ifdef WITH_TRIGGER
 static bool trigger_btn_callback (RobWidget *widget, void* data)
 {
   SiScoUI* ui = (SiScoUI*) data;
-  if (ui->trigger_cfg_mode == 1) {
+  if (ui->trigger_cfg_mode == 1 || ui->trigger_cfg_mode == 3) {
     ui->trigger_manual = true;
   }
   return TRUE;
@@ -694,56 +2403,438 @@ static bool trigger_sel_callback (RobWidget *widget, void* data)
       robtk_spin_set_sensitive(ui->spb_trigger_pos, true);
       setup_trigger(ui);
       break;
+#ifdef WITH_SEGMENTS
+    case 3:
+      robtk_cbtn_set_sensitive(ui->btn_pause, true);
+      robtk_spin_set_sensitive(ui->spb_trigger_hld, false);
+      robtk_spin_set_sensitive(ui->spb_trigger_lvl, true);
+      robtk_spin_set_sensitive(ui->spb_trigger_pos, true);
+      setup_trigger(ui);
+      break;
+#endif
   }
+#ifdef WITH_SEGMENTS
+  robtk_select_set_sensitive(ui->sel_seg_num, ui->trigger_cfg_mode == 3);
+  robtk_spin_set_sensitive(ui->spb_seg_show, ui->trigger_cfg_mode == 3);
+#endif
+#ifdef WITH_SWEEPAVG
+  robtk_select_set_sensitive(ui->sel_trigger_avg, ui->trigger_cfg_mode == 2);
+#endif
+  robtk_select_set_sensitive(ui->sel_trigger_kind, ui->trigger_cfg_mode > 0);
+  robtk_spin_set_sensitive(ui->spb_trigger_par, ui->trigger_cfg_mode > 0
+      && robtk_select_get_item(ui->sel_trigger_kind) != TRIG_EDGE);
+  robtk_spin_set_sensitive(ui->spb_trigger_hys, ui->trigger_cfg_mode > 0
+      && robtk_select_get_item(ui->sel_trigger_kind) <= TRIG_PULSE_LT);
+  robtk_select_set_sensitive(ui->sel_trigger_hfr, ui->trigger_cfg_mode > 0);
 #ifdef WITH_MARKERS
   marker_control_sensitivity(ui, false);
 #endif
 
-  ui_state(data);
+  ui_state(data);
+  queue_draw(ui->darea);
+  return TRUE;
+}
+
+/** the meaning and range of the parameter depend on the kind of trigger */
+static bool trigger_kind_callback (RobWidget *widget, void* data)
+{
+  SiScoUI* ui = (SiScoUI*) data;
+  const uint32_t kind = robtk_select_get_item(ui->sel_trigger_kind);
+  switch(kind) {
+    case TRIG_PULSE_GT:
+    case TRIG_PULSE_LT:
+      robtk_lbl_set_text(ui->lbl_tpar, "Width [ms]: ");
+      robtk_spin_update_range(ui->spb_trigger_par, 0.01, 50.0, 0.01);
+      break;
+    case TRIG_SLOPE:
+      robtk_lbl_set_text(ui->lbl_tpar, "Slope [1/ms]: ");
+      robtk_spin_update_range(ui->spb_trigger_par, 0.01, 20.0, 0.01);
+      break;
+    case TRIG_WINDOW_EXIT:
+    case TRIG_WINDOW_ENTER:
+      robtk_lbl_set_text(ui->lbl_tpar, "Band \u00b1: ");
+      robtk_spin_update_range(ui->spb_trigger_par, 0.01, 1.0, 0.01);
+      break;
+    case TRIG_RUNT:
+      robtk_lbl_set_text(ui->lbl_tpar, "Height: ");
+      robtk_spin_update_range(ui->spb_trigger_par, 0.01, 1.0, 0.01);
+      break;
+    default:
+      break;
+  }
+  robtk_spin_set_sensitive(ui->spb_trigger_par, ui->trigger_cfg_mode > 0 && kind != TRIG_EDGE);
+  robtk_spin_set_sensitive(ui->spb_trigger_hys, ui->trigger_cfg_mode > 0 && kind <= TRIG_PULSE_LT);
+  ui_state(data);
+  return TRUE;
+}
+#endif
+
+
+/******************************************************************************
+ * Data Preprocessing and triggering logic
+ */
+
+
+#ifdef WITH_ACQMODES
+/** reduce samples to the current column according to the acquisition mode.
+ * Sample and hi-res columns are a single value (min == max),
+ * while hi-res accumulates, data_rms holds the sum of the samples.
+ */
+static inline void acq_reduce(SiScoUI *ui, ScoChan *chn, float const *data, const uint32_t n)
+{
+  const uint32_t i = chn->idx;
+  switch (ui->acq_mode) {
+    case AM_SAMPLE:
+      if (chn->sub == 0 && n > 0) {
+	chn->data_min[i] = chn->data_max[i] = data[0];
+	chn->data_rms[i] = data[0] * data[0] * ui->stride;
+      }
+      break;
+    case AM_HIRES:
+      sco_reduce_sum(data, n, &chn->data_rms[i]);
+      break;
+    default:
+      ui->reduce(data, n, &chn->data_min[i], &chn->data_max[i], &chn->data_rms[i]);
+      break;
+  }
+}
+
+/** the current column is complete */
+static inline void acq_column(SiScoUI *ui, ScoChan *chn)
+{
+  if (ui->acq_mode == AM_HIRES) {
+    const uint32_t i = chn->idx;
+    const float avg = chn->data_rms[i] / ui->stride;
+    chn->data_min[i] = chn->data_max[i] = avg;
+    chn->data_rms[i] = avg * avg * ui->stride;
+  }
+}
+
+/** start a new envelope, e.g. when the time-scale changes */
+static void reset_envelope(SiScoUI *ui)
+{
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    ScoChan *env = &ui->env[c];
+    for (uint32_t i = 0; i < env->bufsiz; ++i) {
+      env->data_min[i] =  INFINITY;
+      env->data_max[i] = -INFINITY;
+    }
+    env->idx = 0;
+    ui->env_wrap[c] = false;
+  }
+}
+
+/** port_event() thread: merge the completed columns of the current
+ * sweep into the envelope and show the envelope instead */
+static void acq_envelope(SiScoUI *ui, const uint32_t c)
+{
+  ScoChan *chn = &ui->chn[c];
+  ScoChan *env = &ui->env[c];
+  const uint32_t n = MIN(chn->bufsiz, env->bufsiz);
+  const uint32_t idx = MIN(chn->idx, n);
+
+  /* in free-running mode, columns past idx hold the previous sweep
+   * once the display wrapped around */
+  if (idx < env->idx
+#ifdef WITH_TRIGGER
+      && ui->trigger_state == TS_DISABLED
+#endif
+     ) {
+    ui->env_wrap[c] = true;
+  }
+  env->idx = idx;
+
+  sco_envelope(chn->data_min, chn->data_max, env->data_min, env->data_max, idx);
+  if (ui->env_wrap[c] && idx + 1 < n
+#ifdef WITH_TRIGGER
+      && ui->trigger_state == TS_DISABLED
+#endif
+     ) {
+    sco_envelope(&chn->data_min[idx + 1], &chn->data_max[idx + 1],
+	&env->data_min[idx + 1], &env->data_max[idx + 1], n - idx - 1);
+  }
+}
+#endif
+
+/** parse raw audio data from and prepare for later drawing */
+static int process_channel(SiScoUI *ui, ScoChan *chn,
+    const size_t n_elem, float const *data,
+    uint32_t *idx_start, uint32_t *idx_end)
+{
+  int overflow = 0;
+  const uint32_t stride = ui->stride;
+  *idx_start = chn->idx;
+  for (uint32_t i = 0; i < n_elem;) {
+    /* reduce the remainder of the current column in one go */
+    const uint32_t n = chn->sub < stride ? MIN(n_elem - i, stride - chn->sub) : 0;
+#ifdef WITH_ACQMODES
+    acq_reduce(ui, chn, &data[i], n);
+#else
+    ui->reduce(&data[i], n,
+	&chn->data_min[chn->idx], &chn->data_max[chn->idx], &chn->data_rms[chn->idx]);
+#endif
+    i += n;
+    chn->sub += n;
+    if (chn->sub >= stride) {
+#ifdef WITH_ACQMODES
+      acq_column(ui, chn);
+#endif
+      chn->sub = 0;
+      if (++chn->idx >= chn->bufsiz) {
+	chn->idx = 0;
+	++overflow;
+      }
+      chn->data_min[chn->idx] =  1.0;
+      chn->data_max[chn->idx] = -1.0;
+      chn->data_rms[chn->idx] = 0;
+    }
+  }
+  *idx_end = chn->idx;
+  return overflow;
+}
+
+#ifdef WITH_DECIMATION
+/** add min/max/rms columns, pre-processed by the DSP */
+static int process_columns(SiScoUI *ui, ScoChan *chn,
+    const size_t n_cols, float const *data,
+    uint32_t *idx_start, uint32_t *idx_end)
+{
+  int overflow = 0;
+  *idx_start = chn->idx;
+  for (uint32_t i = 0; i < n_cols; ++i, data += 3) {
+    /* merge, in case raw-data of this column was already processed */
+    if (data[0] < chn->data_min[chn->idx]) { chn->data_min[chn->idx] = data[0]; }
+    if (data[1] > chn->data_max[chn->idx]) { chn->data_max[chn->idx] = data[1]; }
+    chn->data_rms[chn->idx] += data[2];
+    chn->sub = 0;
+    chn->idx = (chn->idx + 1) % chn->bufsiz;
+    if (chn->idx == 0) {
+      ++overflow;
+    }
+    chn->data_min[chn->idx] =  1.0;
+    chn->data_max[chn->idx] = -1.0;
+    chn->data_rms[chn->idx] = 0;
+  }
+  *idx_end = chn->idx;
+  return overflow;
+}
+#endif
+
+
+#ifdef WITH_TRIGGER
+/** (re)allocate and clear the trigger-buffer.
+ * It must hold a screen-width plus one period of columns: with the
+ * trigger-position at 100%, the trigger can be at the end of a period
+ * and all of the screen before it is still needed.
+ * The size is the same for all channels, computed at the first one
+ * from the period of the first channel that has data (cur_period),
+ * a longer period of a later channel grows it.
+ * returns false if allocation fails.
+ */
+static bool reserve_trigger_buf(SiScoUI* ui, const uint32_t channel, const size_t n_samples)
+{
+#ifdef WITH_RESAMPLING
+  const size_t period = MAX(n_samples, ui->cur_period * ui->src_fact);
+#else
+  const size_t period = MAX(n_samples, ui->cur_period);
+#endif
+  const uint32_t bufsiz = DAWIDTH + period / ui->stride + 2;
+  if (channel == 0 || bufsiz > ui->trigger_bufsiz) {
+    ui->trigger_bufsiz = bufsiz;
+  }
+  ScoChan *tbf = &ui->trigger_buf[channel];
+  if (tbf->bufsiz != ui->trigger_bufsiz) {
+    return try_realloc_sco_chan(tbf, ui->trigger_bufsiz);
+  }
+  zero_sco_chan(tbf);
+  return true;
+}
+
+#ifdef WITH_SEGMENTS
+static void free_segments(SiScoUI* ui)
+{
+  for (uint32_t i = 0; i < ui->seg_size * ui->n_channels; ++i) {
+    free_sco_chan(&ui->seg[i]);
+  }
+  free(ui->seg);
+  ui->seg = NULL;
+  ui->seg_size = 0;
+}
+
+/** (re)allocate the arena for the selected number of segments,
+ * and start a new capture. returns false, without an arena,
+ * if allocation fails */
+static bool alloc_segments(SiScoUI* ui)
+{
+  const uint32_t num = 8 << robtk_select_get_item(ui->sel_seg_num);
+  ui->seg_count = 0;
+  if (ui->seg_size < num || ui->seg_width != DAWIDTH) {
+    free_segments(ui);
+    ui->seg = (ScoChan*) calloc(num * ui->n_channels, sizeof(ScoChan));
+    if (!ui->seg) {
+      return false;
+    }
+    ui->seg_size = num;
+    for (uint32_t i = 0; i < num * ui->n_channels; ++i) {
+      if (!try_realloc_sco_chan(&ui->seg[i], DAWIDTH)) {
+	free_segments(ui);
+	return false;
+      }
+    }
+    ui->seg_width = DAWIDTH;
+  }
+  ui->seg_num = num;
+  ui->seg_show = -1;
+  ui->seg_cols = 0;
+  ui->seg_armed = ui->trigger_cfg_pos;
+  ui->seg_pend_n = 0;
+  return true;
+}
+
+static inline ScoChan* segment(SiScoUI* ui, const uint32_t s, const uint32_t channel)
+{
+  return &ui->seg[s * ui->n_channels + channel];
+}
+
+/** show segment 1..seg_count, or an overlay of all of them (0) */
+static void show_segment(SiScoUI* ui, const int show)
+{
+  ui->seg_show = show;
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    ScoChan *chn = &ui->chn[c];
+    if (show > 0) {
+      copy_sco_chan(chn, segment(ui, show - 1, c));
+    } else {
+      const uint32_t n = MIN(chn->bufsiz, ui->seg_width);
+      copy_sco_chan(chn, segment(ui, 0, c));
+      chn->shift = 0;
+      for (uint32_t s = 1; s < ui->seg_count; ++s) {
+	const ScoChan *sc = segment(ui, s, c);
+	for (uint32_t i = 0; i < n; ++i) {
+	  chn->data_min[i] = MIN(chn->data_min[i], sc->data_min[i]);
+	  chn->data_max[i] = MAX(chn->data_max[i], sc->data_max[i]);
+	  chn->data_rms[i] = MAX(chn->data_rms[i], sc->data_rms[i]);
+	}
+      }
+    }
+    chn->idx = DAWIDTH - 1;
+    chn->sub = 0;
+  }
+  ui->update_ann = true;
   queue_draw(ui->darea);
-  return TRUE;
 }
-#endif
 
+/** copy the windows of pending triggers, once their post-trigger
+ * data is complete, from the trigger-buffer into the arena */
+static void collect_segments(SiScoUI* ui)
+{
+  const uint32_t pos = ui->trigger_cfg_pos;
+  uint32_t done = 0;
+  while (done < ui->seg_pend_n) {
+    const ScoSegTrig *st = &ui->seg_pend[done];
+    const uint64_t start = st->col - pos;
+    if (ui->seg_cols < start + DAWIDTH) {
+      break;
+    }
+    const uint32_t s = ui->seg_count++;
+    ui->seg_time[s] = st->time;
+    for (uint32_t c = 0; c < ui->n_channels; ++c) {
+      const ScoChan *tbf = &ui->trigger_buf[c];
+      ScoChan *sc = segment(ui, s, c);
+      const uint32_t tbsz = tbf->bufsiz;
+      const uint32_t off = (tbf->idx + tbsz - (ui->seg_cols - start) % tbsz) % tbsz;
+      for (uint32_t i = 0; i < DAWIDTH; ++i) {
+	sc->data_min[i] = tbf->data_min[(i + off) % tbsz];
+	sc->data_max[i] = tbf->data_max[(i + off) % tbsz];
+	sc->data_rms[i] = tbf->data_rms[(i + off) % tbsz];
+      }
+      sc->shift = st->frac;
+    }
+    ++done;
+  }
+  if (done == 0) {
+    return;
+  }
+  ui->seg_pend_n -= done;
+  memmove(ui->seg_pend, &ui->seg_pend[done], ui->seg_pend_n * sizeof(ScoSegTrig));
+
+  show_segment(ui, ui->seg_count);
+#ifdef WITH_PHOSPHOR
+  if (ui->display == DM_PHOSPHOR) {
+    for (uint32_t c = 0; c < ui->n_channels; ++c) {
+      ph_feed_columns(ui, c, &ui->chn[c], DAWIDTH);
+    }
+  }
+#endif
+  if (ui->seg_count == ui->seg_num) {
+    ui->seg_pend_n = 0;
+    next_tigger_state(ui, TS_END);
+  }
+}
 
-/******************************************************************************
- * Data Preprocessing and triggering logic
+/** segmented memory: the trigger-buffer records continuously,
+ * every trigger is queued and re-arms at the end of its window.
  */
+static int process_segments(SiScoUI* ui, uint32_t channel, size_t n_samples, float const *audiobuffer)
+{
+  ScoChan *tbf = &ui->trigger_buf[channel];
+  const uint32_t tbsz = tbf->bufsiz;
+  const uint32_t stride = ui->stride;
 
+  if (DAWIDTH + n_samples / stride + 2 > tbsz) {
+    next_tigger_state(ui, TS_INITIALIZING);
+    return -1;
+  }
 
-/** parse raw audio data from and prepare for later drawing */
-static int process_channel(SiScoUI *ui, ScoChan *chn,
-    const size_t n_elem, float const *data,
-    uint32_t *idx_start, uint32_t *idx_end)
-{
-  int overflow = 0;
-  *idx_start = chn->idx;
-  for (uint32_t i = 0; i < n_elem; ++i) {
-    if (data[i] < chn->data_min[chn->idx]) { chn->data_min[chn->idx] = data[i]; }
-    if (data[i] > chn->data_max[chn->idx]) { chn->data_max[chn->idx] = data[i]; }
-    chn->data_rms[chn->idx] += data[i] * data[i];
-    if (++chn->sub >= ui->stride) {
-      chn->sub = 0;
-      chn->idx = (chn->idx + 1) % chn->bufsiz;
-      if (chn->idx == 0) {
-	++overflow;
+  uint32_t idx_start, idx_end;
+  const uint32_t sub0 = tbf->sub;
+  const int overflow = process_channel(ui, tbf, n_samples, audiobuffer, &idx_start, &idx_end);
+
+  if (channel == ui->trigger_cfg_channel) {
+    const uint64_t col0 = ui->seg_cols; // column of sub0
+    uint32_t avail = ui->seg_num - ui->seg_count - ui->seg_pend_n;
+    int32_t k;
+    for (uint32_t i = 0; i < n_samples
+	&& (k = sco_trigger_scan(&ui->trigger, &audiobuffer[i], n_samples - i, 0)) >= 0;
+	++i) {
+      /* interpolated crossing, in samples and in columns */
+      const double x = MAX(0., i + ui->trigger.cross);
+      const double p = MAX(0., col0 + (sub0 + i + ui->trigger.cross) / stride);
+      const uint64_t col = p;
+      i += k;
+      if (col < ui->seg_armed || avail == 0 || ui->seg_pend_n == SEG_PENDING) {
+	continue;
       }
-      chn->data_min[chn->idx] =  1.0;
-      chn->data_max[chn->idx] = -1.0;
-      chn->data_rms[chn->idx] = 0;
+      ScoSegTrig *st = &ui->seg_pend[ui->seg_pend_n++];
+      st->col = col;
+      st->frac = p - col;
+#ifdef WITH_RESAMPLING
+      st->time = (ui->seg_samples + x) / ui->src_fact;
+#else
+      st->time = ui->seg_samples + x;
+#endif
+      ui->seg_armed = col + MAX(1, DAWIDTH - ui->trigger_cfg_pos);
+      --avail;
     }
+    ui->seg_samples += n_samples;
+    ui->seg_adv = (uint64_t)overflow * tbsz + idx_end - idx_start;
   }
-  *idx_end = chn->idx;
-  return overflow;
-}
 
+  if (channel + 1 == ui->n_channels) {
+    ui->seg_cols += ui->seg_adv;
+    ui->seg_adv = 0;
+    collect_segments(ui);
+  }
+  return -1;
+}
+#endif
 
-#ifdef WITH_TRIGGER
 static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, float const *audiobuffer)
 {
   size_t n_samples = *n_samples_p;
 
   if (ui->trigger_state == TS_DISABLED) {
+    ui->chn[channel].shift = 0;
     return 0;
   }
 
@@ -757,11 +2848,29 @@ static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, f
       next_tigger_state(ui, TS_PREBUFFER);
     }
     ui->trigger_collect_ok = false;
-    zero_sco_chan(&ui->trigger_buf[channel]);
+    if (!reserve_trigger_buf(ui, channel, n_samples)) {
+      /* out of memory, retry with the next period */
+      next_tigger_state(ui, TS_INITIALIZING);
+      return -1;
+    }
     if (ui->trigger_cfg_mode == 1) {
       zero_sco_chan(&ui->chn[channel]);
     }
-    ui->trigger_prev = ui->trigger_cfg_lvl;
+#ifdef WITH_SEGMENTS
+    if (ui->trigger_cfg_mode == 3) {
+      if (channel == 0 && !alloc_segments(ui)) {
+	/* out of memory, retry with the next period */
+	next_tigger_state(ui, TS_INITIALIZING);
+	return -1;
+      }
+      if (channel == 0) {
+	ui->seg_samples = 0;
+	ui->seg_adv = 0;
+      }
+      zero_sco_chan(&ui->chn[channel]);
+    }
+#endif
+    sco_trigger_reset(&ui->trigger, ui->trigger_cfg_lvl);
 
     if (channel + 1 == ui->n_channels) {
       queue_draw(ui->darea);
@@ -779,10 +2888,67 @@ static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, f
     return -1;
   }
 
+#ifdef WITH_SEGMENTS
+  else if (ui->trigger_state == TS_PREBUFFER && ui->trigger_cfg_mode == 3) {
+    if (!ui->seg) {
+      /* the arena could not be allocated */
+      next_tigger_state(ui, TS_INITIALIZING);
+      return -1;
+    }
+    return process_segments(ui, channel, n_samples, audiobuffer);
+  }
+#endif
+
+#ifdef WITH_DSP_TRIGGER
+  else if (ui->trigger_state == TS_PREBUFFER && ui->trigger_dsp) {
+    /* the DSP sends the complete window, once triggered */
+    if (!ui->trigger_win[channel]) {
+      if (channel == 0) {
+	ui->trigger_nowin += n_samples;
+      }
+      return -1;
+    }
+    ScoChan *chn = &ui->chn[channel];
+    zero_sco_chan(chn);
+
+    if (channel + 1 == ui->n_channels) {
+      if (ui->stride_vis != ui->stride
+#ifdef WITH_RESAMPLING
+	  || ui->src_fact_vis != ui->src_fact
+#endif
+	 ) {
+	ui->update_ann = true;
+	ui->stride_vis = ui->stride;
+#ifdef WITH_RESAMPLING
+	ui->src_fact_vis = ui->src_fact;
+#endif
+      }
+      queue_draw(ui->darea);
+    }
+
+    const size_t max_remain = MIN(n_samples, (DAWIDTH - 1) * ui->stride);
+    if (max_remain < n_samples) {
+      next_tigger_state(ui, TS_END);
+    } else {
+      next_tigger_state(ui, TS_COLLECT);
+    }
+    *n_samples_p = max_remain;
+    return 0;
+  }
+#endif
+
   else if (ui->trigger_state == TS_PREBUFFER) {
     uint32_t idx_start, idx_end;
     idx_start = idx_end = 0;
+    const uint32_t tbsz = ui->trigger_buf[channel].bufsiz;
+
+    if (DAWIDTH + n_samples / ui->stride + 2 > tbsz) {
+      /* host buffer-size increased, re-allocate */
+      next_tigger_state(ui, TS_INITIALIZING);
+      return -1;
+    }
 
+    const uint32_t sub0 = ui->trigger_buf[channel].sub;
     int overflow = process_channel(ui, &ui->trigger_buf[channel], n_samples, audiobuffer, &idx_start, &idx_end);
     size_t trigger_scan_start;
 
@@ -794,7 +2960,7 @@ static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, f
       trigger_scan_start = 0;
     } else if (overflow > 0 || idx_end >= ui->trigger_cfg_pos) {
       ui->trigger_collect_ok = true;
-      uint32_t voff = (idx_end + TRBUFSZ - ui->trigger_cfg_pos) % TRBUFSZ;
+      uint32_t voff = (idx_end + tbsz - ui->trigger_cfg_pos) % tbsz;
       assert(n_samples >= voff * ui->stride);
       trigger_scan_start = n_samples - voff * ui->stride;
     } else {
@@ -802,27 +2968,14 @@ static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, f
       return -1;
     }
 
-    const float trigger_lvl = ui->trigger_cfg_lvl;
-    if (ui->trigger_cfg_type == 0) {
-      // RISING EDGE
-      for (uint32_t i = trigger_scan_start; i < n_samples; ++i) {
-	if (ui->trigger_prev < trigger_lvl && audiobuffer[i] >= trigger_lvl) {
-	  next_tigger_state(ui, TS_TRIGGERED);
-	  ui->trigger_offset = idx_start + i / ui->stride;
-	  break;
-	}
-	ui->trigger_prev = audiobuffer[i];
-      }
-    } else {
-      // FALLING EDGE
-      for (uint32_t i = trigger_scan_start; i < n_samples; ++i) {
-	if (ui->trigger_prev > trigger_lvl && audiobuffer[i] <= trigger_lvl) {
-	  next_tigger_state(ui, TS_TRIGGERED);
-	  ui->trigger_offset = idx_start + i / ui->stride;
-	  break;
-	}
-	ui->trigger_prev = audiobuffer[i];
-      }
+    const int32_t i = sco_trigger_scan(&ui->trigger, audiobuffer, n_samples, trigger_scan_start);
+    if (i >= 0) {
+      next_tigger_state(ui, TS_TRIGGERED);
+      /* column of the interpolated crossing, sample sub0 is in idx_start */
+      const double p = (sub0 + ui->trigger.cross) / ui->stride;
+      const int64_t col = floor(p);
+      ui->trigger_offset = (idx_start + tbsz + col) % tbsz;
+      ui->trigger_frac = p - col;
     }
     return -1;
   }
@@ -833,20 +2986,28 @@ static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, f
     zero_sco_chan(chn);
     const uint32_t pos = ui->trigger_cfg_pos;
 
-    const uint32_t ofx = ui->trigger_offset % TRBUFSZ;
-    const uint32_t exs = (tbf->idx + TRBUFSZ - ofx) % TRBUFSZ;
+    const uint32_t tbsz = tbf->bufsiz;
+
+    const uint32_t ofx = ui->trigger_offset % tbsz;
+    const uint32_t exs = (tbf->idx + tbsz - ofx) % tbsz;
 
     // when  i == pos;  then (i+off)%DW == ui->trigger_offset
-    const uint32_t off = (ui->trigger_offset + TRBUFSZ - pos) % TRBUFSZ;
+    const uint32_t off = (ui->trigger_offset + tbsz - pos) % tbsz;
     const uint32_t ncp = MIN(DAWIDTH, ui->trigger_cfg_pos + exs + 1);
 
     for (uint32_t i=0; i < ncp; ++i) {
-      chn->data_min[i] = tbf->data_min[(i+off)%TRBUFSZ];
-      chn->data_max[i] = tbf->data_max[(i+off)%TRBUFSZ];
-      chn->data_rms[i] = tbf->data_rms[(i+off)%TRBUFSZ];
+      chn->data_min[i] = tbf->data_min[(i+off)%tbsz];
+      chn->data_max[i] = tbf->data_max[(i+off)%tbsz];
+      chn->data_rms[i] = tbf->data_rms[(i+off)%tbsz];
     }
     chn->idx = (ncp + DAWIDTH - 1)%DAWIDTH;
     chn->sub = tbf->sub;
+    chn->shift = ui->trigger_frac;
+#ifdef WITH_PHOSPHOR
+    if (ui->display == DM_PHOSPHOR) {
+      ph_feed_columns(ui, channel, chn, ncp);
+    }
+#endif
 
     if (channel + 1 == ui->n_channels) {
       if (ui->stride_vis != ui->stride
@@ -891,7 +3052,7 @@ static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, f
       float holdoff = robtk_spin_get_value(ui->spb_trigger_hld);
       if (holdoff > 0) {
 	next_tigger_state(ui, TS_DELAY);
-	ui->trigger_delay = ceilf(holdoff * ui->rate / ui->cur_period);
+	ui->trigger_delay = ceilf(holdoff * ui->rate / MAX(1, ui->cur_period));
       } else {
 	next_tigger_state(ui, TS_INITIALIZING);
       }
@@ -907,6 +3068,19 @@ static int process_trigger(SiScoUI* ui, uint32_t channel, size_t *n_samples_p, f
 	next_tigger_state(ui, TS_INITIALIZING);
       }
     }
+#ifdef WITH_SEGMENTS
+    else if (ui->trigger_cfg_mode == 3) {
+      robtk_pbtn_set_sensitive(ui->btn_trigger_man, true);
+#ifdef WITH_MARKERS
+      marker_control_sensitivity(ui, true);
+#endif
+      if (ui->trigger_manual) {
+	robtk_pbtn_set_sensitive(ui->btn_trigger_man, false);
+	ui->trigger_manual = false;
+	next_tigger_state(ui, TS_INITIALIZING);
+      }
+    }
+#endif
     return -1;
   }
 
@@ -991,6 +3165,149 @@ static void render_text(
   cairo_new_path (cr);
 }
 
+#ifdef WITH_PROFILING
+/** per-stage summary in the bottom-right corner of the scope */
+static void render_profile(SiScoUI* ui, cairo_t *cr) {
+  char txt[512];
+  int off = snprintf(txt, sizeof(txt), "%-8s %8s %8s %8s %8s\n",
+      "stage", "count", "mean", "p99", "max[us]");
+  for (uint32_t i = 0; i < PROF_LAST; ++i) {
+    const ScoProf *p = &ui->prof[i];
+    const uint64_t n = __atomic_load_n(&p->count, __ATOMIC_RELAXED);
+    off += snprintf(txt + off, sizeof(txt) - off, "%-8s %8llu %8.1f %8.1f %8.1f\n",
+	prof_name[i], (unsigned long long) n,
+	n > 0 ? 1e-3 * __atomic_load_n(&p->sum, __ATOMIC_RELAXED) / n : 0,
+	1e-3 * prof_quantile(p, .99),
+	1e-3 * __atomic_load_n(&p->max, __ATOMIC_RELAXED));
+  }
+
+  /* UI time spent per wall-clock time, and expose vs frame-budget */
+  const uint64_t elapsed = prof_now() - ui->prof_since;
+  const uint64_t busy =
+    __atomic_load_n(&ui->prof[PROF_SCOPE].sum, __ATOMIC_RELAXED)
+    + __atomic_load_n(&ui->prof[PROF_EXPOSE].sum, __ATOMIC_RELAXED);
+  snprintf(txt + off, sizeof(txt) - off,
+      "lost: %llu/%llu msgs  load: %.1f%%  frame: %.0f%%",
+      (unsigned long long) ui->rx_lost,
+      (unsigned long long) (ui->rx_msgs + ui->rx_lost),
+      elapsed > 0 ? 100.0 * busy / elapsed : 0,
+      100.0 * prof_quantile(&ui->prof[PROF_EXPOSE], .99) / PROF_FRAME_NS);
+
+  render_text(cr, txt, ui->font[3], DAWIDTH - 4, DAHEIGHT - 4, 0, -4, color_wht);
+}
+#endif
+
+#ifdef WITH_XYMODE
+/** X/Y display: graticule and one mask-blit per channel pair */
+static void render_xy(SiScoUI* ui, cairo_t *cr) {
+  int x0, y0, side;
+  xy_area(ui, &x0, &y0, &side);
+  const double ctr = rint(side * .5) - .5;
+
+  cairo_save(cr);
+  cairo_rectangle (cr, 0, 0, DAWIDTH, DAHEIGHT);
+  cairo_clip(cr);
+  CairoSetSouerceRGBA(color_blk);
+  cairo_paint(cr);
+
+  cairo_set_line_width(cr, 1.0);
+  CairoSetSouerceRGBA(color_grd);
+  cairo_rectangle(cr, x0 + .5, y0 + .5, side - 1, side - 1);
+  cairo_stroke(cr);
+  CairoSetSouerceRGBA(color_zro);
+  cairo_move_to(cr, x0 + ctr, y0);
+  cairo_line_to(cr, x0 + ctr, y0 + side);
+  cairo_move_to(cr, x0, y0 + ctr);
+  cairo_line_to(cr, x0 + side, y0 + ctr);
+  cairo_stroke(cr);
+
+  if (ui->display == DM_GONIO) {
+    static const double dashed[] = {1.5};
+    cairo_set_dash(cr, dashed, 1, 0);
+    cairo_move_to(cr, x0, y0);
+    cairo_line_to(cr, x0 + side, y0 + side);
+    cairo_move_to(cr, x0 + side, y0);
+    cairo_line_to(cr, x0, y0 + side);
+    cairo_stroke(cr);
+    cairo_set_dash(cr, NULL, 0, 0);
+    render_text(cr, "L", ui->font[0], x0 + 4, y0 + 4, 0, 9, color_gry);
+    render_text(cr, "R", ui->font[0], x0 + side - 4, y0 + 4, 0, 7, color_gry);
+  }
+
+  cairo_translate(cr, x0, y0);
+  cairo_scale(cr, side / (double) XY_SIZE, side / (double) XY_SIZE);
+  cairo_set_operator(cr, CAIRO_OPERATOR_ADD);
+  for (uint32_t p = 0; p < ui->n_channels / 2; ++p) {
+    cairo_surface_t *sf = acquire_xy(&ui->xy[p]);
+    if (!ui->visible[2 * p] && !ui->visible[2 * p + 1]) continue;
+    CairoSetSouerceRGBA(color_chn[2 * p]);
+    cairo_mask_surface(cr, sf, 0, 0);
+  }
+  cairo_restore(cr);
+}
+#endif
+
+#ifdef WITH_SPECTRUM
+/** spectrum display: log-frequency, dBFS grid and one trace per channel */
+static void render_spectrum(SiScoUI* ui, cairo_t *cr) {
+  char txt[16];
+  cairo_save(cr);
+  cairo_rectangle(cr, 0, 0, DAWIDTH, DAHEIGHT);
+  cairo_clip(cr);
+  cairo_set_source_rgba(cr, 0, 0, 0, 1.0);
+  cairo_paint(cr);
+
+  cairo_set_line_width(cr, 1.0);
+  for (int db = 0; db <= SPEC_DBRANGE; db += 20) {
+    const float y = spec_ypos(ui, -db);
+    CairoSetSouerceRGBA(db == 0 ? color_zro : color_grd);
+    cairo_move_to(cr, 0, y);
+    cairo_line_to(cr, DAWIDTH, y);
+    cairo_stroke(cr);
+    if (db > 0 && db < SPEC_DBRANGE) {
+      snprintf(txt, 16, "-%d", db);
+      render_text(cr, txt, ui->font[0], 3, y, 0, 3, color_gry);
+    }
+  }
+
+  /* 1-2-5 frequency grid */
+  for (float decade = 10.f; decade < ui->rate * .5f; decade *= 10.f) {
+    static const float mult[3] = {1, 2, 5};
+    for (int i = 0; i < 3; ++i) {
+      const float freq = decade * mult[i];
+      if (freq < SPEC_FMIN || freq > ui->rate * .5f) continue;
+      const float x = rintf(spec_xpos(ui, freq)) + .5f;
+      CairoSetSouerceRGBA(color_grd);
+      cairo_move_to(cr, x, 0);
+      cairo_line_to(cr, x, DAHEIGHT);
+      cairo_stroke(cr);
+      if (freq >= 1000.f) {
+	snprintf(txt, 16, "%.0fk", freq / 1000.f);
+      } else {
+	snprintf(txt, 16, "%.0f", freq);
+      }
+      render_text(cr, txt, ui->font[0], x, DAHEIGHT - 2, 0, 5, color_gry);
+    }
+  }
+
+  cairo_set_line_width(cr, 1.5);
+  cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    const float *col = acquire_spec(&ui->spec[c]);
+    if (!ui->visible[c]) continue;
+    const uint32_t width = MIN(DAWIDTH, ui->spec[c].width);
+    for (int pk = ui->fft_peak ? 1 : 0; pk >= 0; --pk) {
+      cairo_move_to(cr, 0, spec_ypos(ui, col[pk]));
+      for (uint32_t x = 1; x < width; ++x) {
+	cairo_line_to(cr, x, spec_ypos(ui, col[2 * x + pk]));
+      }
+      cairo_set_source_rgba(cr, color_chn[c][0], color_chn[c][1], color_chn[c][2], pk ? .5 : 1.0);
+      cairo_stroke(cr);
+    }
+  }
+  cairo_restore(cr);
+}
+#endif
 
 static void dial_annotation_val(RobTkDial * d, cairo_t *cr, void *data) {
   SiScoUI* ui = (SiScoUI*) (data);
@@ -1325,8 +3642,7 @@ static void update_marker_data(SiScoUI* ui, uint32_t id) {
   assert (c >=0 && c <= ui->n_channels);
   assert (pos >=0 && pos < (int)DAWIDTH);
 
-  ScoChan *chn = &ui->chn[c];
-  if (ui->hold[c]) chn = &ui->mem[c];
+  ScoChan *chn = display_chn(ui, c);
 
   pos -= rintf(ui->xoff[c]);
   if (pos < 0 || pos >= (int)DAWIDTH || pos == (int)chn->idx) {
@@ -1467,8 +3783,7 @@ static void render_markers(SiScoUI* ui, cairo_t *cr) {
     for(uint32_t c = 0 ; c < ui->n_channels; ++c) {
       if (!ui->visible[c]) continue;
       if (!ui->cann[c]) continue;
-      ScoChan *chn = &ui->chn[c];
-      if (ui->hold[c]) chn = &ui->mem[c];
+      ScoChan *chn = display_chn(ui, c);
       float d_rms = 0, d_min = 1.0, d_max = -1.0;
       uint32_t d_cnt = 0;
 
@@ -1633,11 +3948,204 @@ static void render_markers(SiScoUI* ui, cairo_t *cr) {
 }
 #endif
 
+/* drawing area Y-position of given sample-value
+ * note: cairo-pixel at 0 spans -.5 .. +.5, hence (DFLTAMPL / 2.0 -.5)
+ * also the cairo Y-axis points upwards
+ */
+#define CYPOS(VAL) ( chn_y_offset - MIN(1.5, MAX (-1.5, (VAL))) * chn_y_scale )
+
+static void free_layer(ScoLayer *l) {
+  if (l->sf) {
+    cairo_surface_destroy(l->sf);
+  }
+  free(l->painted);
+  memset(l, 0, sizeof(ScoLayer));
+}
+
+/** add columns [start, end) of a channel's waveform to the current path */
+static void path_columns(cairo_t* cr, const ScoChan *chn,
+    uint32_t start, const uint32_t end,
+    const float chn_y_offset, const float chn_y_scale, const float so)
+{
+  float prev_min = 0;
+  float prev_max = 0;
+
+  if (start == chn->idx) {
+    start++;
+  }
+
+  if (start < end) {
+    uint32_t spos = start;
+    if (start > 0 && chn->idx + 1 != start) {
+      spos = start - 1;
+    }
+    cairo_move_to(cr, spos - .5, CYPOS(chn->data_max[spos]));
+    prev_min = chn->data_min[spos];
+    prev_max = chn->data_max[spos];
+  }
+
+  for (uint32_t i = start ; i < end; ++i) {
+    if (i == chn->idx) {
+      prev_min = prev_max = 0;
+      cairo_move_to(cr, i, CYPOS(0));
+      continue;
+    }
+    // keep in mind:
+    // * CYPOS is inverted
+    // * lines w/ thickness 1 is from  [x-.5 .. x+.5]
+    // * all columns are part of a single path, stroked once
+    if (chn->data_min[i] == chn->data_max[i]) {
+      cairo_line_to(cr, i -.5, CYPOS(chn->data_min[i]));
+    } else if (chn->data_min[i] > prev_max) {
+      cairo_line_to(cr, i -.75, CYPOS(chn->data_min[i]));
+      cairo_line_to(cr, i -.25, CYPOS(chn->data_max[i]));
+    } else if (chn->data_max[i] < prev_min) {
+      cairo_line_to(cr, i -.75, CYPOS(chn->data_max[i]));
+      cairo_line_to(cr, i -.25, CYPOS(chn->data_min[i]));
+    } else if (chn->data_min[i] > prev_min) {
+      // could go up+right  -- same as chn->data_min[i] > prev_max
+      cairo_line_to(cr, i -.5, CYPOS(chn->data_min[i]));
+      cairo_line_to(cr, i +so, CYPOS(chn->data_max[i]));
+    } else {
+      // could go down+right  -- same chn->data_max[i] < prev_min
+      cairo_line_to(cr, i -.5, CYPOS(chn->data_max[i]));
+      cairo_line_to(cr, i +so, CYPOS(chn->data_min[i]));
+    }
+
+    prev_min = chn->data_min[i];
+    prev_max = chn->data_max[i];
+  }
+}
+
+/** re-render the layer's pixel-columns affected by changed columns
+ * [first .. last]. The line of column i starts at column i-1 and
+ * covers pixels [i-3 .. i], it also moves the start of column i+1.
+ */
+static void repaint_layer(cairo_t* cr, const ScoLayer *l, const ScoChan *chn,
+    const uint32_t first, const uint32_t last, const uint32_t end,
+    const float chn_y_offset, const float chn_y_scale)
+{
+  const uint32_t x0 = first > 3 ? first - 3 : 0;
+  const uint32_t x1 = MIN(l->width, last + 2);
+
+  cairo_save(cr);
+  cairo_rectangle (cr, x0, l->y0, x1 - x0, l->height);
+  cairo_clip(cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+  // lead-in by 2 columns, the path-start may differ from a full render
+  path_columns(cr, chn, x0 > 2 ? x0 - 2 : 0, MIN(end, x1 + 3),
+      chn_y_offset, chn_y_scale, l->so);
+  cairo_stroke (cr);
+  cairo_restore(cr);
+}
+
+/** bring the waveform-layer of channel c up to date with chn,
+ * only columns that differ from the last call are painted.
+ * returns false if the channel is not on screen.
+ */
+static bool paint_layer(SiScoUI* ui, uint32_t c, const ScoChan *chn, const uint32_t end)
+{
+  ScoLayer *l = &ui->layer[c];
+  const float gain = ui->gain[c];
+  const float yoff = ui->yoff[c];
+  const float chn_y_offset = yoff + DACENTER - .5f;
+  const float chn_y_scale = DFLTAMPL * .5f * gain;
+#ifdef DEBUG_WAVERENDER
+  const float so = ui->solidwave ? -.5 : +.5;
+#else
+  const float so = -.5;
+#endif
+
+  const double lower_y = floor (CYPOS (gain < 0 ? -1 : 1));
+  const double upper_y = ceil  (CYPOS (gain < 0 ? 1 : -1));
+  const int y0 = MAX(0, lower_y - 1);
+  const int y1 = MIN(DAHEIGHT, upper_y + 1);
+
+  if (y1 <= y0) {
+    return false;
+  }
+
+  bool full = false;
+  if (!l->sf || l->width != DAWIDTH || l->height != y1 - y0) {
+    free_layer(l);
+    l->sf = cairo_image_surface_create (CAIRO_FORMAT_A8, DAWIDTH, y1 - y0);
+    l->painted = (float*) malloc(2 * DAWIDTH * sizeof(float));
+    if (!l->painted || cairo_surface_status(l->sf) != CAIRO_STATUS_SUCCESS) {
+      /* out of memory, expose skips the channel */
+      free_layer(l);
+      return false;
+    }
+    l->width  = DAWIDTH;
+    l->height = y1 - y0;
+    full = true;
+  }
+  if (full || l->y0 != y0 || l->gain != gain || l->yoff != yoff || l->so != so) {
+    l->y0   = y0;
+    l->gain = gain;
+    l->yoff = yoff;
+    l->so   = so;
+    full = true;
+  }
+
+  cairo_t *cr = cairo_create(l->sf);
+  cairo_translate(cr, 0, -y0);
+  cairo_set_line_width(cr, 1.0);
+  cairo_set_line_join (cr, CAIRO_LINE_JOIN_BEVEL);
+
+  if (full) {
+    cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+    path_columns(cr, chn, 0, end, chn_y_offset, chn_y_scale, so);
+    cairo_stroke (cr);
+  }
+
+  uint32_t first = DAWIDTH;
+  uint32_t last = 0;
+  for (uint32_t i = 0; i < DAWIDTH; ++i) {
+    float col[2];
+    if (i >= end) {
+      col[0] = NAN; col[1] = 0; // not drawn
+    } else if (i == chn->idx) {
+      col[0] = 0; col[1] = NAN; // gap
+    } else {
+      col[0] = chn->data_min[i];
+      col[1] = chn->data_max[i];
+    }
+    if (!memcmp(&l->painted[2 * i], col, sizeof(col))) {
+      continue;
+    }
+    memcpy(&l->painted[2 * i], col, sizeof(col));
+    if (full) {
+      continue;
+    }
+    if (first < DAWIDTH && i > last + 6) {
+      repaint_layer(cr, l, chn, first, last, end, chn_y_offset, chn_y_scale);
+      first = DAWIDTH;
+    }
+    if (first == DAWIDTH) {
+      first = i;
+    }
+    last = i;
+  }
+  if (first < DAWIDTH) {
+    repaint_layer(cr, l, chn, first, last, end, chn_y_offset, chn_y_scale);
+  }
+
+  cairo_destroy(cr);
+  return true;
+}
+
 /* gdk drawing area draw callback
  * -- this runs in gtk's main thread */
 static bool expose_event(RobWidget* handle, cairo_t* cr, cairo_rectangle_t *ev)
 {
   SiScoUI* ui = (SiScoUI*) GET_HANDLE(handle);
+  const uint64_t t_expose = prof_start(ui);
+
+  acquire_display(ui);
 
   if (ui->update_ann) {
     update_annotations(ui);
@@ -1665,12 +4173,59 @@ static bool expose_event(RobWidget* handle, cairo_t* cr, cairo_rectangle_t *ev)
     return TRUE;
   }
 
+#ifdef WITH_XYMODE
+  if (display_xy(ui)) {
+    render_xy(ui, cr);
+  }
+#endif
+#ifdef WITH_SPECTRUM
+  if (ui->display == DM_SPECTRUM) {
+    render_spectrum(ui, cr);
+  }
+#endif
+  if (ui->display != DM_SCOPE && ui->display != DM_PHOSPHOR) {
+#ifdef WITH_PROFILING
+    if (ui->profile) {
+      render_profile(ui, cr);
+    }
+#endif
+    prof_stop(ui, PROF_EXPOSE, t_expose);
+    return TRUE;
+  }
+
+#ifdef WITH_SEGMENTS
+  if (ui->trigger_cfg_mode == 3 && ui->seg_count > 0 && ui->seg_show >= 0
+      && (ui->trigger_state == TS_PREBUFFER || ui->trigger_state == TS_END)) {
+    char txt[64];
+    if (ui->seg_show > 0) {
+      const uint32_t s = ui->seg_show - 1;
+      snprintf(txt, 64, "Segment %u/%u  %+.4f s", s + 1,
+	  ui->trigger_state == TS_END ? ui->seg_count : ui->seg_num,
+	  (ui->seg_time[s] - ui->seg_time[0]) / ui->rate);
+    } else {
+      snprintf(txt, 64, "Overlay of %u segments", ui->seg_count);
+    }
+    render_text(cr, txt, ui->font[1],
+	ANRTEXT, ANLINE1,
+	0, 1, color_wht);
+  }
+#endif
+#ifdef WITH_SWEEPAVG
+  if (!ui->paused && sweep_averaging(ui)) {
+    char txt[32];
+    const uint32_t n = ui->avg_held ? ui->avg_n : MIN(ui->avg_count, ui->avg_n);
+    snprintf(txt, 32, "Average %u/%u", n, ui->avg_n);
+    render_text(cr, txt, ui->font[1],
+	ANRTEXT, DAHEIGHT + ANLINE3,
+	0, 1, color_wht);
+  } else
+#endif
 #ifdef WITH_TRIGGER
   if (!ui->paused) // NB. trigger-state shares space w/Marker
   switch(ui->trigger_state) {
     case TS_END:
 #ifdef WITH_MARKERS
-      if (ui->trigger_cfg_mode != 1)
+      if (!trigger_held(ui))
 #endif
       render_text(cr, "Acquisition complete", ui->font[1],
 	  ANRTEXT, DAHEIGHT + ANLINE3,
@@ -1710,25 +4265,27 @@ static bool expose_event(RobWidget* handle, cairo_t* cr, cairo_rectangle_t *ev)
     const float gain = ui->gain[c];
     const float yoff = ui->yoff[c];
     const float x_offset = rintf(ui->xoff[c]);
-    ScoChan *chn = &ui->chn[c];
-    if (ui->hold[c]) chn = &ui->mem[c];
-
-    uint32_t start = MAX(MIN(DAWIDTH, ev->x - x_offset), 0);
-    uint32_t end   = MAX(MIN(DAWIDTH, ev->x + ev->width - x_offset), 0);
+    ScoChan *chn = display_chn(ui, c);
 
+    uint32_t end = DAWIDTH;
 #ifdef WITH_TRIGGER
     if (ui->trigger_cfg_mode > 0) {
-      end = MIN(end, ui->chn[c].idx);
+      end = MIN(end, ui->dpy[c]->idx);
     }
 #endif
 
-    /* drawing area Y-position of given sample-value
-     * note: cairo-pixel at 0 spans -.5 .. +.5, hence (DFLTAMPL / 2.0 -.5)
-     * also the cairo Y-axis points upwards
-     */
+#ifdef WITH_PHOSPHOR
+    const bool phosphor = ui->display == DM_PHOSPHOR;
+#else
+    const bool phosphor = false;
+#endif
+
+    if (!phosphor && !paint_layer(ui, c, chn, end)) {
+      continue;
+    }
+
     const float chn_y_offset = yoff + DACENTER - .5f;
     const float chn_y_scale = DFLTAMPL * .5f * gain;
-#define CYPOS(VAL) ( chn_y_offset - MIN(1.5, MAX (-1.5, (VAL))) * chn_y_scale )
 
     cairo_save(cr);
     cairo_set_operator (cr, CAIRO_OPERATOR_ADD);
@@ -1736,76 +4293,28 @@ static bool expose_event(RobWidget* handle, cairo_t* cr, cairo_rectangle_t *ev)
     const double lower_y = floor (CYPOS (gain < 0 ? -1 : 1));
     const double upper_y = ceil  (CYPOS (gain < 0 ? 1 : -1));
 
-    cairo_rectangle (cr, 0, floor (lower_y) - 1, DAWIDTH, upper_y - lower_y + 2);
-    cairo_clip(cr);
-
-    CairoSetSouerceRGBA(color_chn[c]);
-    cairo_set_line_join (cr, CAIRO_LINE_JOIN_BEVEL);
-
-    pthread_mutex_lock(&chn->lock);
-
-    float prev_min = 0;
-    float prev_max = 0;
-#ifdef DEBUG_WAVERENDER
-    const float so = ui->solidwave ? -.5 : +.5;
-#else
-    const float so = -.5;
-#endif
-
-    if (start == chn->idx) {
-      start++;
-    }
-
-    if (start < end && start < DAWIDTH) {
-      uint32_t spos = start;
-      if (start > 0 && chn->idx + 1 != start) {
-	spos = start - 1;
-      }
-      cairo_move_to(cr, spos - .5 + x_offset, CYPOS(chn->data_max[spos]));
-      prev_min = chn->data_min[spos];
-      prev_max = chn->data_max[spos];
+#ifdef WITH_PHOSPHOR
+    if (phosphor) {
+      /* the histogram exceeds the channel's [-1..+1] area */
+      const double ph_top = chn_y_offset - DFLTAMPL * .5 * PH_RANGE;
+      cairo_save(cr);
+      cairo_rectangle (cr, 0, floor (ph_top), DAWIDTH, ceil (DFLTAMPL * PH_RANGE) + 1);
+      cairo_clip(cr);
+      cairo_translate(cr, x_offset, ph_top);
+      cairo_scale(cr, 1.0, DFLTAMPL * PH_RANGE / (double) PH_BINS);
+      cairo_set_source_surface(cr, acquire_phosphor(&ui->ph[c]), 0, 0);
+      cairo_paint(cr);
+      cairo_restore(cr);
     }
+#endif
 
-    for (uint32_t i = start ; i < end; ++i) {
-      if (i == chn->idx) {
-	prev_min = prev_max = 0;
-	cairo_move_to(cr, i + x_offset, CYPOS(0));
-	continue;
-      }
-      // keep in mind:
-      // * CYPOS is inverted
-      // * lines w/ thickness 1 is from  [x-.5 .. x+.5]
-      // TODO, combine paths, remember last move_to
-      if (chn->data_min[i] == chn->data_max[i]) {
-	cairo_line_to(cr, i -.5  + x_offset, CYPOS(chn->data_min[i]));
-	cairo_stroke (cr);
-	cairo_move_to(cr, i -.5  + x_offset, CYPOS(chn->data_min[i]));
-      } else if (chn->data_min[i] > prev_max) {
-	cairo_line_to(cr, i -.75 + x_offset, CYPOS(chn->data_min[i]));
-	cairo_line_to(cr, i -.25 + x_offset, CYPOS(chn->data_max[i]));
-	cairo_stroke (cr);
-	cairo_move_to(cr, i -.25 + x_offset, CYPOS(chn->data_max[i]));
-      } else if (chn->data_max[i] < prev_min) {
-	cairo_line_to(cr, i -.75 + x_offset, CYPOS(chn->data_max[i]));
-	cairo_line_to(cr, i -.25 + x_offset, CYPOS(chn->data_min[i]));
-	cairo_stroke (cr);
-	cairo_move_to(cr, i -.25 + x_offset, CYPOS(chn->data_min[i]));
-      } else if (chn->data_min[i] > prev_min) {
-	// could go up+right  -- same as chn->data_min[i] > prev_max
-	cairo_line_to(cr, i -.5  + x_offset, CYPOS(chn->data_min[i]));
-	cairo_line_to(cr, i +so  + x_offset, CYPOS(chn->data_max[i]));
-	cairo_stroke (cr);
-	cairo_move_to(cr, i +so  + x_offset, CYPOS(chn->data_max[i]));
-      } else {
-	// could go down+right  -- same chn->data_max[i] < prev_min
-	cairo_line_to(cr, i -.5  + x_offset, CYPOS(chn->data_max[i]));
-	cairo_line_to(cr, i +so  + x_offset, CYPOS(chn->data_min[i]));
-	cairo_stroke (cr);
-	cairo_move_to(cr, i +so  + x_offset, CYPOS(chn->data_min[i]));
-      }
+    cairo_rectangle (cr, 0, floor (lower_y) - 1, DAWIDTH, upper_y - lower_y + 2);
+    cairo_clip(cr);
 
-      prev_min = chn->data_min[i];
-      prev_max = chn->data_max[i];
+    if (!phosphor) {
+      CairoSetSouerceRGBA(color_chn[c]);
+      /* sub-column alignment of triggered captures, interpolated by cairo */
+      cairo_mask_surface(cr, ui->layer[c].sf, x_offset - chn->shift, ui->layer[c].y0);
     }
 
     /* current position vertical-line */
@@ -1815,7 +4324,6 @@ static bool expose_event(RobWidget* handle, cairo_t* cr, cairo_rectangle_t *ev)
       cairo_line_to(cr, chn->idx - .5 + x_offset, chn_y_offset + chn_y_scale);
       cairo_stroke (cr);
     }
-    pthread_mutex_unlock(&chn->lock);
 
 #ifdef WITH_TRIGGER
     if (ui->trigger_cfg_mode > 0 && c == ui->trigger_cfg_channel) {
@@ -1862,18 +4370,198 @@ static bool expose_event(RobWidget* handle, cairo_t* cr, cairo_rectangle_t *ev)
 #ifdef WITH_MARKERS
   if (ui->paused
 #ifdef WITH_TRIGGER
-      || (ui->trigger_state == TS_END && ui->trigger_cfg_mode == 1)
+      || trigger_held(ui)
 #endif
       ) {
     render_markers(ui, cr);
   }
 #endif
+#ifdef WITH_PROFILING
+  if (ui->profile) {
+    render_profile(ui, cr);
+  }
+#endif
+  prof_stop(ui, PROF_EXPOSE, t_expose);
   return TRUE;
 }
 
 
 /******************************************************************************/
 
+/** reset channel 'c' and align it with channel 'ref' */
+static void realign_channel(SiScoUI* ui, const uint32_t c, const uint32_t ref)
+{
+  zero_sco_chan(&ui->chn[c]);
+  ui->chn[c].idx = ui->chn[ref].idx;
+  ui->chn[c].sub = ui->chn[ref].sub;
+#ifdef WITH_TRIGGER
+  if (ui->trigger_buf[c].bufsiz != ui->trigger_buf[ref].bufsiz) {
+    realloc_sco_chan(&ui->trigger_buf[c], ui->trigger_buf[ref].bufsiz);
+  } else {
+    zero_sco_chan(&ui->trigger_buf[c]);
+  }
+  ui->trigger_buf[c].idx = ui->trigger_buf[ref].idx;
+  ui->trigger_buf[c].sub = ui->trigger_buf[ref].sub;
+#endif
+#ifdef WITH_PYRAMID
+  zero_pyramid(&ui->pyr[c]);
+#endif
+#ifdef WITH_DEEPMEM
+  zero_deep(&ui->deep[c]);
+  ui->deep[c].pos = ui->deep[c].raw_from = ui->deep[ref].pos;
+#endif
+}
+
+/** signal gtk's main thread to redraw the widget,
+ * called after the last channel was processed.
+ * also checks for x-runs (channel misalignment).
+ */
+static void queue_scope_redraw(SiScoUI* ui, const int overflow,
+    const uint32_t idx_start, const uint32_t idx_end)
+{
+#ifdef WITH_PROFILING
+  if (ui->profile) {
+    queue_draw_area(ui->darea, DAWIDTH - PROF_OVERLAY_W, DAHEIGHT - PROF_OVERLAY_H,
+	PROF_OVERLAY_W, PROF_OVERLAY_H);
+  }
+#endif
+  if (ui->update_ann) {
+    /* redraw annotations and complete widget */
+    queue_draw(ui->darea);
+  } else if (overflow > 1 || (overflow == 1 && idx_end == idx_start)) {
+    /* redraw complete widget */
+    queue_draw(ui->darea);
+  } else if (idx_end > idx_start) {
+    /* redraw area between start -> end pixel */
+    for (uint32_t c = 0; c < ui->n_channels; ++c) {
+      const float chn_y_offset = ui->yoff[c] + DACENTER -.5;
+      const float gainU = fabsf(ui->gain[c]);
+      const float yspan = ceil (DFLTAMPL * gainU * .5);
+      const double lower_y = floor (chn_y_offset - yspan);
+      const double upper_y = ceil  (chn_y_offset + yspan);
+
+      queue_draw_area(ui->darea, idx_start - 2 + ui->xoff[c],
+          lower_y - 1,
+          3 + idx_end - idx_start,
+          upper_y - lower_y + 2);
+    }
+  } else if (idx_end < idx_start) {
+    /* wrap-around; redraw area between 0 -> start AND end -> right-end */
+    for (uint32_t c = 0; c < ui->n_channels; ++c) {
+      const float chn_y_offset = ui->yoff[c] + DACENTER -.5;
+      const float gainU = fabsf(ui->gain[c]);
+      const float yspan = ceil (DFLTAMPL * gainU * .5);
+      const double lower_y = floor (chn_y_offset - yspan);
+      const double upper_y = ceil  (chn_y_offset + yspan);
+
+      queue_draw_area(ui->darea, idx_start - 2 + ui->xoff[c],
+          lower_y - 1,
+          3 + DAWIDTH - idx_start,
+          upper_y - lower_y + 2);
+      queue_draw_area(ui->darea, 0,
+          lower_y - 1,
+          idx_end + 1 + ui->xoff[c],
+          upper_y - lower_y + 2);
+    }
+  }
+
+  /* align channels that were just un-hidden with the others */
+  int ref = -1;
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    if (!ui->idle[c] && !ui->resync[c]) {
+      ref = c;
+      break;
+    }
+  }
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    if (!ui->resync[c]) continue;
+    ui->resync[c] = false;
+    if (ref >= 0) {
+      realign_channel(ui, c, ref);
+    }
+  }
+
+  /* check alignment (x-runs) */
+  bool ok = true;
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    if (ui->idle[c] || ref < 0 || (int)c == ref) continue;
+    if (ui->chn[c].idx != ui->chn[ref].idx
+#ifdef WITH_TRIGGER
+        || ui->trigger_buf[c].idx != ui->trigger_buf[ref].idx
+#endif
+        ) {
+      ok = false;
+      break;
+    }
+  }
+  /* reset buffers on x-run */
+  if (!ok) {
+    fprintf(stderr, "SiSco.lv2 UI: x-run (DSP <> UI comm buffer under/overflow)\n");
+    for (uint32_t c = 0; c < ui->n_channels; ++c) {
+      zero_sco_chan(&ui->chn[c]);
+#ifdef WITH_TRIGGER
+      zero_sco_chan(&ui->trigger_buf[c]);
+#endif
+#ifdef WITH_PYRAMID
+      zero_pyramid(&ui->pyr[c]);
+#endif
+#ifdef WITH_DEEPMEM
+      zero_deep(&ui->deep[c]);
+#endif
+    }
+#ifdef WITH_TRIGGER
+    next_tigger_state(ui, TS_INITIALIZING);
+#endif
+  }
+
+  /* hand over display data to the drawing thread */
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+#ifdef WITH_ACQMODES
+    if (ui->acq_mode == AM_ENVELOPE) {
+      acq_envelope(ui, c);
+    }
+#endif
+#ifdef WITH_SWEEPAVG
+    if (sweep_averaging(ui)) {
+      publish_sco_snap(&ui->snap[c], &ui->avg[c]);
+      continue;
+    }
+#endif
+    publish_sco_snap(&ui->snap[c], &ui->chn[c]);
+  }
+}
+
+/** collect the display range that changed from all channels that
+ * receive data (hidden channels are idle and do not advance).
+ * The channels are aligned, if they disagree redraw everything.
+ * Queues the redraw after the last channel.
+ */
+static void note_scope_redraw(SiScoUI* ui, const uint32_t channel,
+    const int overflow, const uint32_t idx_start, const uint32_t idx_end)
+{
+  if (!ui->idle[channel]) {
+    if (!ui->rdw_set) {
+      ui->rdw_set = true;
+      ui->rdw_overflow = overflow;
+      ui->rdw_start = idx_start;
+      ui->rdw_end = idx_end;
+    } else if (idx_start != ui->rdw_start || idx_end != ui->rdw_end) {
+      ui->rdw_overflow = 2; // complete widget
+    } else {
+      ui->rdw_overflow = MAX(ui->rdw_overflow, overflow);
+    }
+  }
+
+  if (channel + 1 == ui->n_channels) {
+    if (ui->rdw_set) {
+      queue_scope_redraw(ui, ui->rdw_overflow, ui->rdw_start, ui->rdw_end);
+    } else {
+      queue_scope_redraw(ui, 0, 0, 0);
+    }
+    ui->rdw_set = false;
+  }
+}
+
 /** this callback runs in the "communication" thread of the LV2-host
  * -- invoked via port_event(); please see notes there.
  *
@@ -1905,26 +4593,27 @@ static void update_scope_real(SiScoUI* ui, const uint32_t channel, const size_t
       ) {
     n_samples = DAWIDTH * ui->stride;
     audiobuffer = &data[n_elem - n_samples];
-    pthread_mutex_lock(&chn->lock);
     chn->idx=0;
     chn->sub=0;
     chn->data_min[chn->idx] =  1.0;
     chn->data_max[chn->idx] = -1.0;
     chn->data_rms[chn->idx] = 0;
-    pthread_mutex_unlock(&chn->lock);
   } else {
     n_samples = n_elem;
     audiobuffer = data;
   }
   assert(n_samples <= n_elem);
 
-  pthread_mutex_lock(&chn->lock);
-
 #ifdef WITH_TRIGGER
   if (process_trigger(ui, channel, &n_samples, audiobuffer) >= 0)
   {
 #endif
 
+#ifdef WITH_PHOSPHOR
+  if (ui->display == DM_PHOSPHOR) {
+    ph_feed(ui, channel, chn->idx, chn->sub, n_samples, audiobuffer);
+  }
+#endif
   /* process this channel's audio-data for display */
   overflow = process_channel(ui, chn, n_samples, audiobuffer, &idx_start, &idx_end);
 
@@ -1932,114 +4621,371 @@ static void update_scope_real(SiScoUI* ui, const uint32_t channel, const size_t
   }
 #endif
 
-  pthread_mutex_unlock(&chn->lock);
-
   /* signal gtk's main thread to redraw the widget after the last channel */
-  if (channel + 1 == ui->n_channels) {
-    if (ui->update_ann) {
-      /* redraw annotations and complete widget */
-      queue_draw(ui->darea);
-    } else if (overflow > 1 || (overflow == 1 && idx_end == idx_start)) {
-      /* redraw complete widget */
-      queue_draw(ui->darea);
-    } else if (idx_end > idx_start) {
-      /* redraw area between start -> end pixel */
+  note_scope_redraw(ui, channel, overflow, idx_start, idx_end);
+}
+
+#ifdef WITH_RESAMPLING
+/** this callback runs in the "communication" thread of the LV2-host
+ *
+ *  counterpart to update_scope_real() for upsampled data without trigger:
+ *  upsample in small chunks and reduce them to display-columns while
+ *  they are still in cache, rather than upsampling the whole period first.
+ */
+static void update_scope_upsampled(SiScoUI* ui, const uint32_t channel, const size_t n_elem, float const * data)
+{
+  uint32_t idx_start, idx_end; // display pixel start/end
+  int overflow = 0;
+  ScoChan *chn = &ui->chn[channel];
+  Interpolator *src = ui->src[channel];
+  const uint32_t fact = ui->src_fact;
+  size_t n_samples = n_elem;
+  uint64_t t_src = 0;
+
+  /* if buffer is larger than display, process only end */
+  if ((n_elem * fact) / ui->stride >= DAWIDTH) {
+    n_samples = (DAWIDTH * ui->stride) / fact;
+    /* only update the interpolator's history */
+    src->inp_count = n_elem - n_samples;
+    src->inp_data = data;
+    src->out_count = (n_elem - n_samples) * fact;
+    src->out_data = NULL;
+    const uint64_t t0 = prof_start(ui);
+    src->process ();
+    t_src += prof_since(t0);
+    data = &data[n_elem - n_samples];
+    chn->idx=0;
+    chn->sub=0;
+    chn->data_min[chn->idx] =  1.0;
+    chn->data_max[chn->idx] = -1.0;
+    chn->data_rms[chn->idx] = 0;
+  }
+
+  idx_start = idx_end = chn->idx;
+  for (size_t i = 0; i < n_samples; i += SRC_CHUNK) {
+    float buf[SRC_CHUNK * MAX_UPSAMPLING];
+    uint32_t s, e;
+    const uint32_t n = MIN(SRC_CHUNK, n_samples - i);
+    src->inp_count = n;
+    src->inp_data = &data[i];
+    src->out_count = n * fact;
+    src->out_data = buf;
+    const uint64_t t0 = prof_start(ui);
+    src->process ();
+    t_src += prof_since(t0);
+#ifdef WITH_PHOSPHOR
+    if (ui->display == DM_PHOSPHOR) {
+      ph_feed(ui, channel, chn->idx, chn->sub, n * fact, buf);
+    }
+#endif
+    overflow += process_channel(ui, chn, n * fact, buf, &s, &e);
+    if (i == 0) {
+      idx_start = s;
+    }
+    idx_end = e;
+  }
+  prof_add(ui, PROF_SRC, t_src);
+
+  note_scope_redraw(ui, channel, overflow, idx_start, idx_end);
+}
+#endif
+
+#ifdef WITH_DECIMATION
+/** this callback runs in the "communication" thread of the LV2-host
+ *
+ *  counterpart to update_scope_real() for data that was already
+ *  reduced to display-columns by the DSP.
+ */
+static void update_scope_columns(SiScoUI* ui, const uint32_t channel,
+    const uint32_t stride, const size_t n_elem, float const * data)
+{
+  uint32_t idx_start, idx_end; // display pixel start/end
+  int overflow = 0;
+  size_t n_cols = n_elem / 3;
+  ScoChan *chn = &ui->chn[channel];
+
+  /* drop columns in flight while the time-scale changes
+   * or the UI needs raw audio (trigger, upsampling) */
+  if (stride != ui->stride
+      || ui->display != DM_SCOPE
+#ifdef WITH_ACQMODES
+      || ui->acq_mode == AM_SAMPLE
+      || ui->acq_mode == AM_HIRES
+#endif
+#ifdef WITH_RESAMPLING
+      || ui->src_fact > 1
+#endif
+#ifdef WITH_TRIGGER
+      || ui->trigger_state != TS_DISABLED
+#endif
+     ) {
+    n_cols = 0;
+  }
+
+  /* if buffer is larger than display, process only end */
+  if (n_cols >= DAWIDTH) {
+    data = &data[3 * (n_cols - DAWIDTH)];
+    n_cols = DAWIDTH;
+    chn->idx=0;
+    chn->sub=0;
+    chn->data_min[chn->idx] =  1.0;
+    chn->data_max[chn->idx] = -1.0;
+    chn->data_rms[chn->idx] = 0;
+  }
+  overflow = process_columns(ui, chn, n_cols, data, &idx_start, &idx_end);
+
+  note_scope_redraw(ui, channel, overflow, idx_start, idx_end);
+}
+#endif
+
+#ifdef WITH_PYRAMID
+/** add received data to the history, at the native rate, before upsampling */
+static void feed_history(SiScoUI* ui, const uint32_t channel, const size_t n_elem, float const * data, const uint32_t decim)
+{
+  if (decim > 0) {
+    pyr_feed_columns(&ui->pyr[channel], decim, n_elem / 3, data);
+  } else {
+    pyr_feed_raw(ui, &ui->pyr[channel], n_elem, data);
+  }
+#ifdef WITH_DEEPMEM
+  if (decim > 0) {
+    deep_feed_columns(ui, &ui->deep[channel], decim, n_elem / 3, data);
+  } else {
+    deep_feed_raw(ui, &ui->deep[channel], n_elem, data);
+  }
+#endif
+}
+#endif
+
+/** check the message's sequence-number, count lost messages.
+ * returns the number of samples that went missing,
+ * 0 if none or if the stream is not contiguous anyway.
+ */
+static uint64_t rx_account(SiScoUI* ui, const uint32_t channel,
+    const uint32_t seq, const uint64_t pos, const uint64_t n_samples)
+{
+  uint64_t gap = 0;
+  ++ui->rx_msgs;
+  if (ui->rx_valid[channel] && seq != ui->rx_seq[channel]) {
+    ui->rx_lost += seq - ui->rx_seq[channel];
+    /* report at most once per second */
+    if (ui->rx_lost_rep == 0 || pos < ui->rx_rep_pos || pos >= ui->rx_rep_pos + ui->rate) {
+      fprintf(stderr, "SiSco.lv2 UI: %llu message(s) lost. Total: %llu of %llu (%.2f%%)\n",
+	  (unsigned long long) (ui->rx_lost - ui->rx_lost_rep),
+	  (unsigned long long) ui->rx_lost,
+	  (unsigned long long) (ui->rx_msgs + ui->rx_lost),
+	  100.0 * ui->rx_lost / (double)(ui->rx_msgs + ui->rx_lost));
+      ui->rx_lost_rep = ui->rx_lost;
+      ui->rx_rep_pos = pos;
+    }
+    if (pos > ui->rx_next[channel]) {
+      gap = pos - ui->rx_next[channel];
+    }
+  }
+  ui->rx_valid[channel] = true;
+  ui->rx_seq[channel] = seq + 1;
+  ui->rx_next[channel] = pos + n_samples;
+  return gap;
+}
+
+/** parse the optional message stamp, see rx_account() */
+static uint64_t rx_stamp(SiScoUI* ui, const int32_t channel,
+    const LV2_Atom* seq, const LV2_Atom* pos, const uint64_t n_samples)
+{
+  if (channel < 0 || channel >= (int32_t)ui->n_channels
+      || !seq || seq->type != ui->uris.atom_Int
+      || !pos || pos->type != ui->uris.atom_Long) {
+    return 0;
+  }
+  return rx_account(ui, channel,
+      ((const LV2_Atom_Int*)seq)->body,
+      ((const LV2_Atom_Long*)pos)->body,
+      n_samples);
+}
+
+/** substitute silence for lost audio: this keeps the channel
+ * aligned with the others, instead of resetting all buffers.
+ */
+static void fill_gap(SiScoUI* ui, const uint32_t channel, uint64_t n_samples)
+{
+  if (ui->paused || ui->idle[channel] || n_samples == 0) {
+    return;
+  }
+#ifdef WITH_TRIGGER
+  if (ui->trigger_state != TS_DISABLED) {
+    /* the capture is incomplete, start over */
+    next_tigger_state(ui, TS_INITIALIZING);
+    return;
+  }
+#endif
+
+#ifdef WITH_PYRAMID
+  if (n_samples > ui->rate) {
+    zero_pyramid(&ui->pyr[channel]);
+#ifdef WITH_DEEPMEM
+    zero_deep(&ui->deep[channel]);
+#endif
+  } else {
+    pyr_feed_zeros(&ui->pyr[channel], n_samples);
+#ifdef WITH_DEEPMEM
+    deep_feed_zeros(ui, &ui->deep[channel], n_samples);
+#endif
+  }
+#endif
+
+#ifdef WITH_RESAMPLING
+  n_samples *= ui->src_fact;
+#endif
+  ScoChan *chn = &ui->chn[channel];
+  const uint64_t total = chn->sub + n_samples;
+  const uint64_t n_cols = total / ui->stride;
+  if (chn->data_min[chn->idx] > 0) { chn->data_min[chn->idx] = 0; }
+  if (chn->data_max[chn->idx] < 0) { chn->data_max[chn->idx] = 0; }
+  for (uint64_t i = 1; i <= n_cols && i <= chn->bufsiz; ++i) {
+    const uint32_t idx = (chn->idx + i) % chn->bufsiz;
+    chn->data_min[idx] = chn->data_max[idx] = chn->data_rms[idx] = 0;
+  }
+  chn->idx = (chn->idx + n_cols) % chn->bufsiz;
+  chn->sub = total % ui->stride;
+  if (chn->sub == 0 && n_cols > 0) {
+    chn->data_min[chn->idx] =  1.0;
+    chn->data_max[chn->idx] = -1.0;
+    chn->data_rms[chn->idx] = 0;
+  }
+  queue_draw(ui->darea);
+}
+
+/** this callback runs in the "communication" thread of the LV2-host
+ * -- invoked via port_event(); please see notes there.
+ *
+ *  it acts as 'glue' between LV2 port_event() and GTK expose_event_callback()
+ *
+ *  This is a wrapper, around above 'update_scope_real()' it allows
+ *  to update the UI state in sync with the 1st channel and
+ *  upsamples the data if neccesary.
+ */
+static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_elem, float const * data, const uint32_t decim)
+{
+  /* this callback runs in the "communication" thread of the LV2-host
+   * usually a g_timeout() at ~25fps
+   */
+  if (channel > ui->n_channels) {
+    return;
+  }
+
+  /* the DSP sends empty vectors for hidden channels */
+  if (ui->idle[channel] && n_elem > 0) {
+    ui->resync[channel] = true;
+  }
+  ui->idle[channel] = n_elem == 0;
+
+  /* track the period of the first channel that has data */
+  if (n_elem > 0) {
+    uint32_t c = 0;
+    while (c < channel && ui->idle[c]) {
+      ++c;
+    }
+    if (c == channel) {
+      ui->cur_period = decim > 0 ? (n_elem / 3) * decim : n_elem;
+    }
+  }
+
+  /* update state in sync with 1st channel */
+  if (channel == 0) {
+
+    bool paused = robtk_cbtn_get_active(ui->btn_pause);
+    if (paused != ui->paused) {
+      ui->paused = paused;
+#ifdef WITH_MARKERS
+      marker_control_sensitivity(ui, paused);
+#endif
+#ifdef WITH_PYRAMID
+      /* history is not contiguous after pause */
       for (uint32_t c = 0; c < ui->n_channels; ++c) {
-	const float chn_y_offset = ui->yoff[c] + DACENTER -.5;
-	const float gainU = fabsf(ui->gain[c]);
-	const float yspan = ceil (DFLTAMPL * gainU * .5);
-	const double lower_y = floor (chn_y_offset - yspan);
-	const double upper_y = ceil  (chn_y_offset + yspan);
-
-	queue_draw_area(ui->darea, idx_start - 2 + ui->xoff[c],
-	    lower_y - 1,
-	    3 + idx_end - idx_start,
-	    upper_y - lower_y + 2);
+	zero_pyramid(&ui->pyr[c]);
       }
-    } else if (idx_end < idx_start) {
-      /* wrap-around; redraw area between 0 -> start AND end -> right-end */
-      for (uint32_t c = 0; c < ui->n_channels; ++c) {
-	const float chn_y_offset = ui->yoff[c] + DACENTER -.5;
-	const float gainU = fabsf(ui->gain[c]);
-	const float yspan = ceil (DFLTAMPL * gainU * .5);
-	const double lower_y = floor (chn_y_offset - yspan);
-	const double upper_y = ceil  (chn_y_offset + yspan);
-
-	queue_draw_area(ui->darea, idx_start - 2 + ui->xoff[c],
-	    lower_y - 1,
-	    3 + DAWIDTH - idx_start,
-	    upper_y - lower_y + 2);
-	queue_draw_area(ui->darea, 0,
-	    lower_y - 1,
-	    idx_end + 1 + ui->xoff[c],
-	    upper_y - lower_y + 2);
+#endif
+#ifdef WITH_DEEPMEM
+      /* deep-memory is browsed while paused, reset it on resume */
+      if (!paused) {
+	for (uint32_t c = 0; c < ui->n_channels; ++c) {
+	  zero_deep(&ui->deep[c]);
+	}
+	__atomic_store_n(&ui->deep_epoch, ui->deep_epoch + 1, __ATOMIC_RELEASE);
       }
+      if (!paused && ui->deep_view) {
+	ui->deep_view = false;
+	ui->update_ann = true;
+	for (uint32_t c = 0; c < ui->n_channels; ++c) {
+	  zero_sco_chan(&ui->chn[c]);
+	}
+      }
+#endif
+      queue_draw(ui->darea);
     }
 
-    /* check alignment (x-runs) */
-    bool ok = true;
-    const uint32_t cbx = ui->chn[0].idx;
-#ifdef WITH_TRIGGER
-    const uint32_t tbx = ui->trigger_buf[0].idx;
+    const int display = robtk_select_get_value(ui->sel_display);
+    if (display != ui->display) {
+      ui->display = display;
+#ifdef WITH_XYMODE
+      for (uint32_t p = 0; p < ui->n_channels / 2; ++p) {
+	zero_xy(&ui->xy[p]);
+      }
 #endif
-    for (uint32_t c = 1; c < ui->n_channels; ++c) {
-      if (ui->chn[c].idx != cbx
-#ifdef WITH_TRIGGER
-	  || ui->trigger_buf[c].idx != tbx
+#ifdef WITH_PHOSPHOR
+      for (uint32_t c = 0; c < ui->n_channels; ++c) {
+	zero_phosphor(&ui->ph[c]);
+      }
 #endif
-	  ) {
-	ok = false;
-	break;
+#ifdef WITH_SPECTRUM
+      for (uint32_t c = 0; c < ui->n_channels; ++c) {
+	ui->spec[c].reset = true;
       }
+#endif
+      ui->update_ann = true;
+    }
+#ifdef WITH_SPECTRUM
+    if (ui->display == DM_SPECTRUM) {
+      setup_spectrum(ui);
     }
-    /* reset buffers on x-run */
-    if (!ok) {
-      fprintf(stderr, "SiSco.lv2 UI: x-run (DSP <> UI comm buffer under/overflow)\n");
+#endif
+#ifdef WITH_ACQMODES
+    const int acq_mode = robtk_select_get_value(ui->sel_acq);
+    if (acq_mode != ui->acq_mode) {
+      ui->acq_mode = acq_mode;
+      /* columns in progress are incompatible */
       for (uint32_t c = 0; c < ui->n_channels; ++c) {
-	pthread_mutex_lock(&ui->chn[c].lock);
 	zero_sco_chan(&ui->chn[c]);
 #ifdef WITH_TRIGGER
 	zero_sco_chan(&ui->trigger_buf[c]);
 #endif
-	pthread_mutex_unlock(&ui->chn[c].lock);
       }
+      reset_envelope(ui);
 #ifdef WITH_TRIGGER
-      next_tigger_state(ui, TS_INITIALIZING);
-#endif
-    }
-  }
-}
-
-/** this callback runs in the "communication" thread of the LV2-host
- * -- invoked via port_event(); please see notes there.
- *
- *  it acts as 'glue' between LV2 port_event() and GTK expose_event_callback()
- *
- *  This is a wrapper, around above 'update_scope_real()' it allows
- *  to update the UI state in sync with the 1st channel and
- *  upsamples the data if neccesary.
- */
-static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_elem, float const * data)
-{
-  /* this callback runs in the "communication" thread of the LV2-host
-   * usually a g_timeout() at ~25fps
-   */
-  if (channel > ui->n_channels) {
-    return;
-  }
-  /* update state in sync with 1st channel */
-  if (channel == 0) {
-    ui->cur_period = n_elem;
-
-    bool paused = robtk_cbtn_get_active(ui->btn_pause);
-    if (paused != ui->paused) {
-      ui->paused = paused;
-#ifdef WITH_MARKERS
-      marker_control_sensitivity(ui, paused);
+      if (ui->trigger_state != TS_DISABLED) {
+	next_tigger_state(ui, TS_INITIALIZING);
+      }
 #endif
       queue_draw(ui->darea);
     }
+#endif
 
+#ifdef WITH_SWEEPAVG
+    const uint32_t avg_item = robtk_select_get_item(ui->sel_trigger_avg);
+    const uint32_t avg_n = avg_item > 0 ? 1 << (2 * ((avg_item - 1) % 4 + 1)) : 0;
+    const bool avg_exp = avg_item > 4;
+    if (avg_n != ui->avg_n || avg_exp != ui->avg_exp || ui->trigger_cfg_mode != 2) {
+      if (ui->avg_count > 0 || ui->avg_held) {
+	queue_draw(ui->darea);
+      }
+      reset_sweep_average(ui);
+    }
+    ui->avg_n = avg_n;
+    ui->avg_exp = avg_exp;
+    if (ui->trigger_state_n == TS_END && ui->trigger_state != TS_END) {
+      sweep_average(ui);
+    }
+#endif
 #ifdef WITH_TRIGGER
     if (ui->trigger_state != ui->trigger_state_n) {
       invalidate_ann(ui, 1);
@@ -2057,15 +5003,42 @@ static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_ele
       const uint32_t p_pos = ui->trigger_cfg_pos;
       const uint32_t p_typ = ui->trigger_cfg_channel << 1 | ui->trigger_cfg_type;
       const float    p_lvl = ui->trigger_cfg_lvl;
+      const uint32_t p_knd = ui->trigger_cfg_kind;
+      const float    p_par = ui->trigger_cfg_par;
+      const float    p_hys = ui->trigger_cfg_hys;
+      const float    p_hfr = ui->trigger_cfg_hfr;
 
       ui->trigger_cfg_pos = rintf(DAWIDTH * robtk_spin_get_value(ui->spb_trigger_pos) * .01f);
       ui->trigger_cfg_lvl = robtk_spin_get_value(ui->spb_trigger_lvl);
+      ui->trigger_cfg_kind = robtk_select_get_item(ui->sel_trigger_kind);
+      ui->trigger_cfg_par = robtk_spin_get_value(ui->spb_trigger_par);
+      ui->trigger_cfg_hys = robtk_spin_get_value(ui->spb_trigger_hys);
+      ui->trigger_cfg_hfr = robtk_select_get_value(ui->sel_trigger_hfr);
 
       const uint32_t type = robtk_select_get_item(ui->sel_trigger_type);
       ui->trigger_cfg_channel = type >> 1;
       ui->trigger_cfg_type = type & 1;
 
-      if (p_typ != type || p_pos != ui->trigger_cfg_pos || p_lvl != ui->trigger_cfg_lvl) {
+      /* the trigger scans upsampled data */
+      sco_trigger_config(&ui->trigger, ui->trigger_cfg_kind, ui->trigger_cfg_type,
+	  ui->trigger_cfg_lvl, ui->trigger_cfg_par,
+	  ui->trigger_cfg_hys, ui->trigger_cfg_hfr,
+#ifdef WITH_RESAMPLING
+	  ui->rate * ui->src_fact
+#else
+	  ui->rate
+#endif
+	  );
+
+      if (p_typ != type || p_pos != ui->trigger_cfg_pos || p_lvl != ui->trigger_cfg_lvl
+	  || p_knd != ui->trigger_cfg_kind || p_par != ui->trigger_cfg_par
+	  || p_hys != ui->trigger_cfg_hys || p_hfr != ui->trigger_cfg_hfr) {
+#ifdef WITH_SWEEPAVG
+	reset_sweep_average(ui);
+#endif
+#ifdef WITH_DSP_TRIGGER
+	ui->trigger_dsp_fail = false;
+#endif
 	if (ui->trigger_state == TS_PREBUFFER) {
 	  ui->trigger_state = TS_INITIALIZING;
 	  robtk_pbtn_set_sensitive(ui->btn_trigger_man, ui->trigger_cfg_mode == 1);
@@ -2074,6 +5047,92 @@ static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_ele
       }
     }
 #endif
+
+#ifdef WITH_SEGMENTS
+    if (ui->trigger_cfg_mode == 3) {
+      if (ui->trigger_state == TS_PREBUFFER
+	  && ui->seg_num != 8u << robtk_select_get_item(ui->sel_seg_num)) {
+	next_tigger_state(ui, TS_INITIALIZING);
+      }
+      if (ui->trigger_state == TS_END && ui->seg_count > 0) {
+	const int show = MIN((uint32_t)robtk_spin_get_value(ui->spb_seg_show), ui->seg_count);
+	if (show != ui->seg_show) {
+	  show_segment(ui, show);
+	}
+      }
+    }
+#endif
+
+#ifdef WITH_DSP_TRIGGER
+    /* let the DSP look for the trigger if it can hold the pre-trigger data,
+     * (the UI only sees the captured window) */
+    if (ui->trigger_dsp && (ui->trigger_abort || ui->trigger_nowin > ui->rate)) {
+      /* the DSP gave up, or does not send the window: use the UI's trigger */
+      ui->trigger_dsp_fail = true;
+      ui_request_trigger(ui, 0, 0);
+      if (ui->trigger_state == TS_PREBUFFER || ui->trigger_state == TS_COLLECT) {
+	ui->trigger_state_n = ui->trigger_state = TS_INITIALIZING;
+      }
+    }
+    else if (ui->trigger_dsp
+	&& ui->trigger_state != TS_PREBUFFER
+	&& ui->trigger_state != TS_COLLECT) {
+      ui_request_trigger(ui, 0, 0);
+    }
+    else if (!ui->trigger_dsp && !ui->trigger_dsp_fail && !paused && ui->trigger_state == TS_PREBUFFER
+#ifdef WITH_SEGMENTS
+	&& ui->trigger_cfg_mode != 3
+#endif
+	&& ui->trigger_cfg_pos * ui->stride <= DSP_TRIGGER_BUFSZ / 2
+#ifdef WITH_RESAMPLING
+	&& ui->src_fact <= 1
+#endif
+	) {
+      const uint32_t pre = ui->trigger_cfg_pos * ui->stride;
+      ui_request_trigger(ui, pre, DAWIDTH * ui->stride - pre);
+    }
+    ui->trigger_abort = false;
+#endif
+
+#ifdef WITH_PROFILING
+    if (ui->profile != ui->prof_dsp) {
+      ui_request_profile(ui, ui->profile);
+    }
+    if (ui->profile) {
+      prof_report(ui);
+    }
+#endif
+
+    /* only request channels that are displayed or used as trigger-source,
+     * nothing at all while paused */
+    uint32_t want = 0;
+    if (!(paused
+#ifdef WITH_TRIGGER
+	  && ( ui->trigger_state == TS_DISABLED
+	    || ui->trigger_state == TS_END
+	    || ui->trigger_state == TS_DELAY)
+#endif
+	 )) {
+      for (uint32_t c = 0; c < ui->n_channels; ++c) {
+	if (ui->visible[c] && !ui->hold[c]) {
+	  want |= 1 << c;
+	}
+#ifdef WITH_XYMODE
+	/* X/Y needs both channels of a pair */
+	if (display_xy(ui) && c / 2 < ui->n_channels / 2 && ui->visible[c ^ 1]) {
+	  want |= 1 << c;
+	}
+#endif
+#ifdef WITH_TRIGGER
+	if (ui->trigger_cfg_mode > 0 && ui->trigger_cfg_channel == c) {
+	  want |= 1 << c;
+	}
+#endif
+      }
+    }
+    if (want != ui->want) {
+      ui_request_channels(ui, want);
+    }
   }
 
   const float oxoff = ui->xoff[channel];
@@ -2112,14 +5171,7 @@ static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_ele
   }
 
   if (ui->hold[channel] != o_mem) {
-    if (ui->hold[channel]) {
-      ScoChan *cx = &ui->chn[channel];
-      ScoChan *mx = &ui->mem[channel];
-      memcpy(mx->data_min, cx->data_min, sizeof(float) * cx->bufsiz);
-      memcpy(mx->data_max, cx->data_max, sizeof(float) * cx->bufsiz);
-      memcpy(mx->data_rms, cx->data_rms, sizeof(float) * cx->bufsiz);
-      mx->idx = cx->idx;
-    }
+    /* the drawing thread takes a copy, see acquire_display() */
     queue_draw(ui->darea);
   }
 
@@ -2130,6 +5182,22 @@ static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_ele
 	|| ui->trigger_state == TS_DELAY)
 #endif
       ) {
+#ifdef WITH_DEEPMEM
+    if (channel == 0) {
+      bool dirty = __atomic_exchange_n(&ui->deep_dirty, 0, __ATOMIC_ACQ_REL);
+      if (snap_acquire(&ui->deep_tb)) {
+	/* copy the view, the GUI keeps browsing its own */
+	const ScoDeepView *v = &ui->deep_req[ui->deep_tb.front];
+	if (v->epoch == ui->deep_epoch) {
+	  ui->deep_cur = *v;
+	  ui->deep_view = dirty = true;
+	}
+      }
+      if (dirty && ui->deep_view) {
+	render_deep_view(ui);
+      }
+    }
+#endif
     if (ui->update_ann) {
       queue_draw(ui->darea);
     }
@@ -2171,10 +5239,34 @@ static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_ele
 #endif
 	) {
       ui->update_ann = true;
+#ifdef WITH_PYRAMID
+      /* re-render from history, if the new time-scale allows to */
+      bool use_pyr = true;
+#ifdef WITH_RESAMPLING
+      if (ui->src_fact > 1) use_pyr = false;
+#endif
+#ifdef WITH_TRIGGER
+      if (ui->trigger_state != TS_DISABLED) use_pyr = false;
+#endif
+#ifdef WITH_ACQMODES
+      /* the history holds min/max columns */
+      if (ui->acq_mode == AM_SAMPLE || ui->acq_mode == AM_HIRES) use_pyr = false;
+#endif
+#endif
+#ifdef WITH_ACQMODES
+      reset_envelope(ui);
+#endif
+#ifdef WITH_SWEEPAVG
+      reset_sweep_average(ui);
+#endif
       for (uint32_t c = 0; c < ui->n_channels; ++c) {
-	zero_sco_chan(&ui->mem[c]);
+#ifdef WITH_PYRAMID
+	if (use_pyr && ui->stride >= (1u << ui->pyr[c].base)) {
+	  pyr_render(&ui->pyr[c], &ui->chn[c], ui->stride, 0);
+	} else
+#endif
 	zero_sco_chan(&ui->chn[c]);
-	robtk_cbtn_set_active(ui->btn_mem[channel], false);
+	robtk_cbtn_set_active(ui->btn_mem[c], false);
       }
 #ifdef WITH_TRIGGER
     next_tigger_state(ui, TS_INITIALIZING);
@@ -2182,18 +5274,110 @@ static void update_scope(SiScoUI* ui, const uint32_t channel, const size_t n_ele
     }
   }
 
+  const uint64_t t_scope = prof_start(ui);
+
+#ifdef WITH_PYRAMID
+#ifdef WITH_DSP_TRIGGER
+  /* triggered windows are not contiguous */
+  if (!ui->trigger_dsp)
+#endif
+  feed_history(ui, channel, n_elem, data, decim);
+#endif
+
+#ifdef WITH_DECIMATION
+  /* let the DSP reduce the data if the UI would not need raw samples */
+  if (channel == 0) {
+    uint32_t want = 0;
+    if (ui->stride >= DECIM_MIN_STRIDE
+	&& ui->display == DM_SCOPE
+#ifdef WITH_ACQMODES
+	&& (ui->acq_mode == AM_PEAK || ui->acq_mode == AM_ENVELOPE)
+#endif
+#ifdef WITH_RESAMPLING
+	&& ui->src_fact <= 1
+#endif
+#ifdef WITH_TRIGGER
+	&& ui->trigger_state == TS_DISABLED
+#endif
+       ) {
+      want = ui->stride;
+    }
+    if (want != ui->decim_stride) {
+      ui_request_decimation(ui, want);
+    }
+  }
+#endif
+
+#ifdef WITH_XYMODE
+  if (display_xy(ui)) {
+    if (decim == 0) {
+      xy_feed(ui, channel, n_elem, data);
+    }
+    prof_stop(ui, PROF_SCOPE, t_scope);
+    return;
+  }
+#endif
+
+#ifdef WITH_SPECTRUM
+  if (ui->display == DM_SPECTRUM) {
+    if (decim == 0 && ui->fft_size > 0) {
+      spec_feed(ui, channel, n_elem, data);
+    }
+    prof_stop(ui, PROF_SCOPE, t_scope);
+    return;
+  }
+#endif
+
+#ifdef WITH_PHOSPHOR
+  if (ui->display == DM_PHOSPHOR) {
+    setup_phosphor(ui, channel);
+  }
+#endif
+
+#ifdef WITH_DECIMATION
+  if (decim > 0) {
+    update_scope_columns(ui, channel, decim, n_elem, data);
+  } else
+#endif
 
 #ifdef WITH_RESAMPLING
-  if (ui->src_fact > 1) {
-    ui->src[channel]->inp_count = n_elem;
-    ui->src[channel]->inp_data = data;
-    ui->src[channel]->out_count = n_elem * ui->src_fact;
-    ui->src[channel]->out_data = ui->src_buf[channel];
-    ui->src[channel]->process ();
-    update_scope_real(ui, channel, n_elem * ui->src_fact, ui->src_buf[channel]);
+  if (ui->src_fact > 1
+#ifdef WITH_TRIGGER
+      && ui->trigger_state == TS_DISABLED
+#endif
+     ) {
+    update_scope_upsampled(ui, channel, n_elem, data);
+  } else if (ui->src_fact > 1) {
+    /* the trigger needs the complete upsampled period */
+    if (reserve_src_buf(ui, n_elem * ui->src_fact)) {
+      ui->src[channel]->inp_count = n_elem;
+      ui->src[channel]->inp_data = data;
+      ui->src[channel]->out_count = n_elem * ui->src_fact;
+      ui->src[channel]->out_data = ui->src_buf[channel];
+      const uint64_t t_src = prof_start(ui);
+      ui->src[channel]->process ();
+      prof_stop(ui, PROF_SRC, t_src);
+      update_scope_real(ui, channel, n_elem * ui->src_fact, ui->src_buf[channel]);
+    } else {
+      /* out of memory, the capture is incomplete */
+      next_tigger_state(ui, TS_INITIALIZING);
+    }
   } else
 #endif
   update_scope_real(ui, channel, n_elem, data);
+
+#ifdef WITH_PHOSPHOR
+  if (ui->display == DM_PHOSPHOR && decim == 0) {
+    ScoPhosphor *ph = &ui->ph[channel];
+    ph->fill += n_elem;
+    if (ph->fill >= ui->rate / PH_FPS) {
+      publish_phosphor(ph);
+      queue_draw(ui->darea);
+    }
+  }
+#endif
+
+  prof_stop(ui, PROF_SCOPE, t_scope);
 }
 
 /******************************************************************************
@@ -2222,18 +5406,41 @@ size_allocate(RobWidget* handle, int w, int h) {
   ui->w_amplitude = MAX(200, rint(ui->w_height / ui->n_channels / 4) * 4) - 4;
 
   robwidget_set_size(ui->darea, w, h);
-  for (uint32_t c = 0; c < ui->n_channels; ++c) {
-    pthread_mutex_lock(&ui->chn[c].lock);
-  }
+  pthread_mutex_lock(&ui->resize_lock);
   for (uint32_t c = 0; c < ui->n_channels; ++c) {
     realloc_sco_chan(&ui->chn[c], ui->w_width);
     realloc_sco_chan(&ui->mem[c], ui->w_width);
+    realloc_sco_snap(&ui->snap[c], ui->w_width);
+#ifdef WITH_PHOSPHOR
+    realloc_phosphor(&ui->ph[c], ui->w_width);
+#endif
+#ifdef WITH_SPECTRUM
+    realloc_spec(&ui->spec[c], ui->w_width);
+#endif
+#ifdef WITH_ACQMODES
+    realloc_sco_chan(&ui->env[c], ui->w_width);
+#endif
+#ifdef WITH_SWEEPAVG
+    realloc_sco_chan(&ui->avg[c], ui->w_width);
+    realloc_sco_chan(&ui->avg_sum[c], ui->w_width);
+#endif
+#ifdef WITH_PYRAMID
+    realloc_pyramid(&ui->pyr[c], ui->w_width);
+#endif
+    ui->dpy[c] = &ui->snap[c].buf[ui->snap[c].tb.front];
+    ui->mem_ok[c] = false;
 #ifdef WITH_TRIGGER
     zero_sco_chan(&ui->trigger_buf[c]);
 #endif
     robtk_dial_update_range(ui->spb_xoff[c], -100.0, 100.0, 100.0/(float)DAWIDTH);
     robtk_dial_update_range(ui->spb_yoff[c], -96.0, 96.0, 48.0/(float)DFLTAMPL);
   }
+#ifdef WITH_ACQMODES
+  reset_envelope(ui);
+#endif
+#ifdef WITH_SWEEPAVG
+  reset_sweep_average(ui);
+#endif
 
 #ifdef WITH_TRIGGER
   robtk_spin_update_range(ui->spb_trigger_pos, 0.0, 100.0, 100.0/(float)DAWIDTH);
@@ -2253,9 +5460,7 @@ size_allocate(RobWidget* handle, int w, int h) {
   cairo_surface_destroy(ui->gridnlabels);
   ui->gridnlabels = NULL;
   update_annotations(ui);
-  for (uint32_t c = 0; c < ui->n_channels; ++c) {
-    pthread_mutex_unlock(&ui->chn[c].lock);
-  }
+  pthread_mutex_unlock(&ui->resize_lock);
 }
 
 #else
@@ -2294,6 +5499,9 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
   robwidget_set_mousemove(ui->darea, mouse_move);
   robwidget_set_mouseup  (ui->darea, mouse_up);
 #endif
+#ifdef WITH_DEEPMEM
+  robwidget_set_mousescroll(ui->darea, mouse_scroll);
+#endif
 
   ui->ctable = rob_table_new(/*rows*/7, /*cols*/ 5, FALSE);
 
@@ -2325,6 +5533,9 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
   ui->btn_solidwave = robtk_cbtn_new("SolidWave (debug)", GBT_LED_LEFT, false);
   robtk_cbtn_set_active(ui->btn_solidwave, true);
 #endif
+#ifdef WITH_PROFILING
+  ui->btn_profile = robtk_cbtn_new("Profile (debug)", GBT_LED_LEFT, false);
+#endif
 
 #ifdef WITH_TRIGGER
   ui->spb_trigger_lvl     = robtk_spin_new(-1.0, 1.0, 0.01);
@@ -2350,6 +5561,9 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
   robtk_select_add_item(ui->sel_trigger_mode, 0, "No Trigger");
   robtk_select_add_item(ui->sel_trigger_mode, 1, "Manual");
   robtk_select_add_item(ui->sel_trigger_mode, 2, "Continuous");
+#ifdef WITH_SEGMENTS
+  robtk_select_add_item(ui->sel_trigger_mode, 3, "Segmented");
+#endif
 
   ui->sel_trigger_type = robtk_select_new();
   for (uint32_t c = 0; c < ui->n_channels; ++c) {
@@ -2360,13 +5574,48 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
     robtk_select_add_item(ui->sel_trigger_type, 2*c+1, tmp);
   }
 
+  ui->sel_trigger_kind = robtk_select_new();
+  robtk_select_add_item(ui->sel_trigger_kind, TRIG_EDGE, "Edge");
+  robtk_select_add_item(ui->sel_trigger_kind, TRIG_PULSE_GT, "Pulse >");
+  robtk_select_add_item(ui->sel_trigger_kind, TRIG_PULSE_LT, "Pulse <");
+  robtk_select_add_item(ui->sel_trigger_kind, TRIG_SLOPE, "Slope");
+  robtk_select_add_item(ui->sel_trigger_kind, TRIG_WINDOW_EXIT, "Leave Window");
+  robtk_select_add_item(ui->sel_trigger_kind, TRIG_WINDOW_ENTER, "Enter Window");
+  robtk_select_add_item(ui->sel_trigger_kind, TRIG_RUNT, "Runt");
+
+  ui->lbl_tpar = robtk_lbl_new("Width [ms]: ");
+  robtk_lbl_set_alignment(ui->lbl_tpar, 1.0, 0.5);
+  ui->spb_trigger_par = robtk_spin_new(0.01, 50.0, 0.01);
+  robtk_spin_set_alignment(ui->spb_trigger_par, 0.0, 0.5);
+  robtk_spin_label_width(ui->spb_trigger_par, -1, 0);
+  robtk_spin_set_label_pos(ui->spb_trigger_par, 2);
+
+  ui->sel_trigger_hfr = robtk_select_new();
+  robtk_select_add_item(ui->sel_trigger_hfr,    0, "Full BW");
+  robtk_select_add_item(ui->sel_trigger_hfr, 8000, "HF Rej. 8k");
+  robtk_select_add_item(ui->sel_trigger_hfr, 2000, "HF Rej. 2k");
+  robtk_select_add_item(ui->sel_trigger_hfr,  500, "HF Rej. 500");
+
+  ui->lbl_thys = robtk_lbl_new("Hysteresis: ");
+  robtk_lbl_set_alignment(ui->lbl_thys, 1.0, 0.5);
+  ui->spb_trigger_hys = robtk_spin_new(0, 0.5, 0.005);
+  robtk_spin_set_alignment(ui->spb_trigger_hys, 0.0, 0.5);
+  robtk_spin_label_width(ui->spb_trigger_hys, -1, 0);
+  robtk_spin_set_label_pos(ui->spb_trigger_hys, 2);
+
   robtk_select_set_alignment(ui->sel_trigger_mode, 0, .5);
   robtk_select_set_alignment(ui->sel_trigger_type, 0, .5);
+  robtk_select_set_alignment(ui->sel_trigger_kind, 0, .5);
+  robtk_select_set_alignment(ui->sel_trigger_hfr, 0, .5);
 
   robtk_pbtn_set_sensitive(ui->btn_trigger_man, false);
   robtk_spin_set_sensitive(ui->spb_trigger_hld, false);
   robtk_spin_set_sensitive(ui->spb_trigger_lvl, false);
   robtk_spin_set_sensitive(ui->spb_trigger_pos, false);
+  robtk_select_set_sensitive(ui->sel_trigger_kind, false);
+  robtk_spin_set_sensitive(ui->spb_trigger_par, false);
+  robtk_select_set_sensitive(ui->sel_trigger_hfr, false);
+  robtk_spin_set_sensitive(ui->spb_trigger_hys, false);
 
   robwidget_set_alignment(ui->btn_trigger_man->rw, 0.5, 0.5);
 
@@ -2392,7 +5641,52 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
   robtk_spin_set_default(ui->spb_trigger_hld, 0.5);
   robtk_spin_set_value(ui->spb_trigger_hld, 0.5);
 
+  robtk_spin_set_default(ui->spb_trigger_par, 0.5);
+  robtk_spin_set_value(ui->spb_trigger_par, 0.5);
+  robtk_select_set_item(ui->sel_trigger_kind, TRIG_EDGE);
+
+  robtk_spin_set_default(ui->spb_trigger_hys, 0);
+  robtk_spin_set_value(ui->spb_trigger_hys, 0);
+  robtk_select_set_item(ui->sel_trigger_hfr, 0);
+
   robtk_select_set_item(ui->sel_trigger_mode, 0);
+
+#ifdef WITH_SWEEPAVG
+  ui->sel_trigger_avg = robtk_select_new();
+  robtk_select_add_item(ui->sel_trigger_avg, 0, "No Averaging");
+  robtk_select_add_item(ui->sel_trigger_avg, 1, "Average 4");
+  robtk_select_add_item(ui->sel_trigger_avg, 2, "Average 16");
+  robtk_select_add_item(ui->sel_trigger_avg, 3, "Average 64");
+  robtk_select_add_item(ui->sel_trigger_avg, 4, "Average 256");
+  robtk_select_add_item(ui->sel_trigger_avg, 5, "Exp. Avg 4");
+  robtk_select_add_item(ui->sel_trigger_avg, 6, "Exp. Avg 16");
+  robtk_select_add_item(ui->sel_trigger_avg, 7, "Exp. Avg 64");
+  robtk_select_add_item(ui->sel_trigger_avg, 8, "Exp. Avg 256");
+  robtk_select_set_item(ui->sel_trigger_avg, 0);
+  robtk_select_set_default_item(ui->sel_trigger_avg, 0);
+  robtk_select_set_sensitive(ui->sel_trigger_avg, false);
+#endif
+#ifdef WITH_SEGMENTS
+  ui->sel_seg_num = robtk_select_new();
+  for (uint32_t i = 0; 8u << i <= SEG_MAX; ++i) {
+    char tmp[32];
+    snprintf(tmp, 32, "%u Segments", 8u << i);
+    robtk_select_add_item(ui->sel_seg_num, i, tmp);
+  }
+  robtk_select_set_item(ui->sel_seg_num, 2);
+  robtk_select_set_default_item(ui->sel_seg_num, 2);
+  robtk_select_set_sensitive(ui->sel_seg_num, false);
+
+  ui->lbl_tshow = robtk_lbl_new("Show: ");
+  robtk_lbl_set_alignment(ui->lbl_tshow, 1.0, 0.5);
+  ui->spb_seg_show = robtk_spin_new(0, SEG_MAX, 1);
+  robtk_spin_set_alignment(ui->spb_seg_show, 0.0, 0.5);
+  robtk_spin_label_width(ui->spb_seg_show, -1, 0);
+  robtk_spin_set_label_pos(ui->spb_seg_show, 2);
+  robtk_spin_set_default(ui->spb_seg_show, 0);
+  robtk_spin_set_value(ui->spb_seg_show, 0);
+  robtk_spin_set_sensitive(ui->spb_seg_show, false);
+#endif
   robtk_select_set_item(ui->sel_trigger_type, 0);
 #endif
 
@@ -2417,6 +5711,67 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
   robtk_select_set_item(ui->sel_speed, 10);
   robtk_select_set_default_item(ui->sel_speed, 10);
 
+  ui->sel_display = robtk_select_new();
+  robtk_select_add_item(ui->sel_display, DM_SCOPE, "Scope");
+#ifdef WITH_XYMODE
+  if (ui->n_channels > 1) {
+    robtk_select_add_item(ui->sel_display, DM_XY, "X/Y");
+    robtk_select_add_item(ui->sel_display, DM_GONIO, "Goniometer");
+  }
+#endif
+#ifdef WITH_PHOSPHOR
+  robtk_select_add_item(ui->sel_display, DM_PHOSPHOR, "Phosphor");
+#endif
+#ifdef WITH_SPECTRUM
+  robtk_select_add_item(ui->sel_display, DM_SPECTRUM, "Spectrum");
+#endif
+  robtk_select_set_item(ui->sel_display, 0);
+  robtk_select_set_default_item(ui->sel_display, 0);
+
+#ifdef WITH_ACQMODES
+  ui->sel_acq = robtk_select_new();
+  robtk_select_add_item(ui->sel_acq, AM_SAMPLE,   "Sample");
+  robtk_select_add_item(ui->sel_acq, AM_PEAK,     "Peak");
+  robtk_select_add_item(ui->sel_acq, AM_HIRES,    "Hi-Res");
+  robtk_select_add_item(ui->sel_acq, AM_ENVELOPE, "Envelope");
+  robtk_select_set_item(ui->sel_acq, 1);
+  robtk_select_set_default_item(ui->sel_acq, 1);
+#endif
+
+#ifdef WITH_DEEPMEM
+  ui->sel_deep = robtk_select_new();
+  robtk_select_add_item(ui->sel_deep,  0, "No History");
+  robtk_select_add_item(ui->sel_deep,  5, "History 5s");
+  robtk_select_add_item(ui->sel_deep, 15, "History 15s");
+  robtk_select_add_item(ui->sel_deep, 60, "History 60s");
+  robtk_select_set_item(ui->sel_deep, 0);
+  robtk_select_set_default_item(ui->sel_deep, 0);
+#endif
+
+#ifdef WITH_SPECTRUM
+  ui->sel_fft_size = robtk_select_new();
+  for (int i = SPEC_MIN_LOG2; i <= SPEC_MAX_LOG2; ++i) {
+    char txt[16];
+    snprintf(txt, 16, "FFT %dk", 1 << (i - 10));
+    robtk_select_add_item(ui->sel_fft_size, 1 << i, txt);
+  }
+  robtk_select_set_item(ui->sel_fft_size, 3); // 8k
+  robtk_select_set_default_item(ui->sel_fft_size, 3);
+
+  ui->sel_fft_avg = robtk_select_new();
+  robtk_select_add_item(ui->sel_fft_avg, 1.f,  "No Avg");
+  robtk_select_add_item(ui->sel_fft_avg, .3f,  "Fast Avg");
+  robtk_select_add_item(ui->sel_fft_avg, .05f, "Slow Avg");
+  robtk_select_set_item(ui->sel_fft_avg, 1);
+  robtk_select_set_default_item(ui->sel_fft_avg, 1);
+
+  ui->btn_fft_peak = robtk_cbtn_new("Peak hold", GBT_LED_LEFT, false);
+
+  robtk_select_set_sensitive(ui->sel_fft_size, false);
+  robtk_select_set_sensitive(ui->sel_fft_avg, false);
+  robtk_cbtn_set_sensitive(ui->btn_fft_peak, false);
+#endif
+
 #ifdef WITH_TIME_ADJ
   ui->spb_speed_adj = robtk_spin_new(-1, 1, .02);
   robtk_spin_set_default(ui->spb_speed_adj, 0);
@@ -2479,10 +5834,30 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
 #endif
   row++;
 
+#ifdef WITH_ACQMODES
+  TBLATT(robtk_select_widget(ui->sel_acq), 0, 2, row, row+1, RTK_EXANDF, RTK_SHRINK);
+#endif
+  TBLATT(robtk_select_widget(ui->sel_display), 2, 5, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  row++;
+#ifdef WITH_DEEPMEM
+  TBLATT(robtk_select_widget(ui->sel_deep), 0, 2, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  row++;
+#endif
+#ifdef WITH_SPECTRUM
+  TBLATT(robtk_select_widget(ui->sel_fft_size), 0, 2, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  TBLATT(robtk_select_widget(ui->sel_fft_avg), 2, 3, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  TBLADD(robtk_cbtn_widget(ui->btn_fft_peak), 3, 5, row, row+1);
+  row++;
+#endif
+
 #ifdef DEBUG_WAVERENDER
   TBLADD(robtk_cbtn_widget(ui->btn_solidwave), 0, 4, row, row+1);
   row++;
 #endif
+#ifdef WITH_PROFILING
+  TBLADD(robtk_cbtn_widget(ui->btn_profile), 0, 4, row, row+1);
+  row++;
+#endif
 
   TBLATT(robtk_sep_widget(ui->sep[0]), 0, 5, row, row+1, RTK_EXANDF, RTK_EXANDF); row++;
 
@@ -2568,6 +5943,7 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
     robtk_dial_set_callback(ui->spb_amp[c], cfg_changed, ui);
     robtk_dial_set_callback(ui->spb_yoff[c], cfg_changed, ui);
     robtk_dial_set_callback(ui->spb_xoff[c], cfg_changed, ui);
+    robtk_cbtn_set_callback(ui->btn_chn[c], cfg_changed, ui); // DSP skips hidden channels
     row++;
   }
 
@@ -2616,21 +5992,66 @@ static RobWidget * toplevel(SiScoUI* ui, void * const top)
   TBLADD(robtk_pbtn_widget(ui->btn_trigger_man), 0, 2, row, row+1);
   TBLADD(robtk_lbl_widget(ui->lbl_tpos), 2, 4, row, row+1);
   TBLADD(robtk_spin_widget(ui->spb_trigger_pos), 4, 5, row, row+1); row++;
+  TBLATT(robtk_select_widget(ui->sel_trigger_kind), 0, 2, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  TBLADD(robtk_lbl_widget(ui->lbl_tpar), 2, 4, row, row+1);
+  TBLADD(robtk_spin_widget(ui->spb_trigger_par), 4, 5, row, row+1); row++;
+  TBLATT(robtk_select_widget(ui->sel_trigger_hfr), 0, 2, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  TBLADD(robtk_lbl_widget(ui->lbl_thys), 2, 4, row, row+1);
+  TBLADD(robtk_spin_widget(ui->spb_trigger_hys), 4, 5, row, row+1); row++;
+#ifdef WITH_SWEEPAVG
+  TBLATT(robtk_select_widget(ui->sel_trigger_avg), 0, 2, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  row++;
+#endif
+#ifdef WITH_SEGMENTS
+  TBLATT(robtk_select_widget(ui->sel_seg_num), 0, 2, row, row+1, RTK_EXANDF, RTK_SHRINK);
+  TBLADD(robtk_lbl_widget(ui->lbl_tshow), 2, 4, row, row+1);
+  TBLADD(robtk_spin_widget(ui->spb_seg_show), 4, 5, row, row+1);
+  row++;
+#endif
 
 #endif
 
   /* signals */
   robtk_select_set_callback(ui->sel_speed, cfg_changed, ui);
+#ifdef WITH_ACQMODES
+  robtk_select_set_callback(ui->sel_acq, cfg_changed, ui);
+#endif
+#ifdef WITH_DEEPMEM
+  robtk_select_set_callback(ui->sel_deep, deep_sel_callback, ui);
+#endif
+#ifdef WITH_SPECTRUM
+  robtk_select_set_callback(ui->sel_display, display_sel_callback, ui);
+  robtk_select_set_callback(ui->sel_fft_size, cfg_changed, ui);
+  robtk_select_set_callback(ui->sel_fft_avg, cfg_changed, ui);
+  robtk_cbtn_set_callback(ui->btn_fft_peak, cfg_changed, ui);
+#else
+  robtk_select_set_callback(ui->sel_display, cfg_changed, ui);
+#endif
   robtk_cbtn_set_callback(ui->btn_latch, latch_btn_callback, ui);
   robtk_cbtn_set_callback(ui->btn_align, align_btn_callback, ui);
 
 #ifdef DEBUG_WAVERENDER
   robtk_cbtn_set_callback(ui->btn_solidwave, solidwave_btn_callback, ui);
 #endif
+#ifdef WITH_PROFILING
+  robtk_cbtn_set_callback(ui->btn_profile, profile_btn_callback, ui);
+#endif
 
 #ifdef WITH_TRIGGER
   robtk_pbtn_set_callback(ui->btn_trigger_man, trigger_btn_callback, ui);
   robtk_select_set_callback(ui->sel_trigger_mode, trigger_sel_callback, ui);
+#ifdef WITH_SWEEPAVG
+  robtk_select_set_callback(ui->sel_trigger_avg, cfg_changed, ui);
+#endif
+#ifdef WITH_SEGMENTS
+  robtk_select_set_callback(ui->sel_seg_num, cfg_changed, ui);
+  robtk_spin_set_callback(ui->spb_seg_show, cfg_changed, ui);
+#endif
+  robtk_select_set_callback(ui->sel_trigger_type, cfg_changed, ui);
+  robtk_select_set_callback(ui->sel_trigger_kind, trigger_kind_callback, ui);
+  robtk_spin_set_callback(ui->spb_trigger_par, cfg_changed, ui);
+  robtk_select_set_callback(ui->sel_trigger_hfr, cfg_changed, ui);
+  robtk_spin_set_callback(ui->spb_trigger_hys, cfg_changed, ui);
   robtk_spin_set_callback(ui->spb_trigger_lvl, cfg_changed, ui);
   robtk_spin_set_callback(ui->spb_trigger_pos, cfg_changed, ui);
 #endif
@@ -2730,6 +6151,10 @@ instantiate(
 #ifdef WITH_TRIGGER
   ui->trigger_cfg_mode = 0;
   ui->trigger_cfg_type = 0;
+  ui->trigger_cfg_kind = TRIG_EDGE;
+  ui->trigger_cfg_par = .5;
+  ui->trigger_cfg_hys = 0;
+  ui->trigger_cfg_hfr = 0;
   ui->trigger_cfg_channel = 0;
   ui->trigger_cfg_pos = DAWIDTH * .5; // 50%
   ui->trigger_cfg_lvl = 0;
@@ -2737,8 +6162,10 @@ instantiate(
   ui->trigger_state = TS_DISABLED;
   ui->trigger_state_n = TS_DISABLED;
 
+  /* grown as needed, see reserve_trigger_buf() */
+  ui->trigger_bufsiz = DAWIDTH;
   for (uint32_t c = 0; c < ui->n_channels; ++c) {
-    ui->trigger_buf[c].bufsiz = TRBUFSZ;
+    ui->trigger_buf[c].bufsiz = DAWIDTH;
     alloc_sco_chan(&ui->trigger_buf[c]);
   }
 #endif
@@ -2747,10 +6174,49 @@ instantiate(
     ui->mem[c].bufsiz = DAWIDTH;
     alloc_sco_chan(&ui->chn[c]);
     alloc_sco_chan(&ui->mem[c]);
+    alloc_sco_snap(&ui->snap[c], DAWIDTH);
+    ui->dpy[c] = &ui->snap[c].buf[ui->snap[c].tb.front];
+    ui->mem_ok[c] = false;
+#ifdef WITH_PHOSPHOR
+    alloc_phosphor(&ui->ph[c], DAWIDTH);
+    phosphor_lut(&ui->ph[c], color_chn[c]);
+#endif
+#ifdef WITH_SPECTRUM
+    alloc_spec(&ui->spec[c], DAWIDTH);
+#endif
+#ifdef WITH_ACQMODES
+    ui->env[c].bufsiz = DAWIDTH;
+    alloc_sco_chan(&ui->env[c]);
+#endif
+#ifdef WITH_SWEEPAVG
+    ui->avg[c].bufsiz = DAWIDTH;
+    ui->avg_sum[c].bufsiz = DAWIDTH;
+    alloc_sco_chan(&ui->avg[c]);
+    alloc_sco_chan(&ui->avg_sum[c]);
+#endif
+#ifdef WITH_PYRAMID
+    alloc_pyramid(&ui->pyr[c], PYR_BASE, DAWIDTH, 0);
+#endif
+  }
+#ifdef WITH_DEEPMEM
+  snap_init(&ui->deep_tb);
+#endif
+#ifdef WITH_XYMODE
+  for (uint32_t p = 0; p < ui->n_channels / 2; ++p) {
+    alloc_xy(&ui->xy[p]);
   }
+#endif
+  ui->display = DM_SCOPE;
+#ifdef WITH_ACQMODES
+  ui->acq_mode = AM_PEAK;
+  reset_envelope(ui);
+#endif
+  pthread_mutex_init(&ui->resize_lock, NULL);
+  ui->reduce = sco_reduce_select();
 
   map_sco_uris(ui->map, &ui->uris);
   lv2_atom_forge_init(&ui->forge, ui->map);
+  lv2_atom_forge_init(&ui->forge_pe, ui->map);
 
   *widget = toplevel(ui, ui_toplevel);
 
@@ -2761,6 +6227,9 @@ instantiate(
   ui->font[3] = pango_font_description_from_string("Mono 8");
 
   calc_gridspacing(ui);
+#ifdef WITH_RESAMPLING
+  init_src_cache(ui);
+#endif
   ui->stride = calc_stride(ui);
 #ifdef WITH_RESAMPLING
   ui->src_fact_vis = ui->src_fact;
@@ -2793,16 +6262,61 @@ cleanup(LV2UI_Handle handle)
    */
   ui_disable(ui);
 
+#ifdef WITH_PROFILING
+  if (ui->profile) {
+    prof_dump(ui);
+  }
+#endif
+
   for (uint32_t c = 0; c < ui->n_channels; ++c) {
 #ifdef WITH_TRIGGER
     free_sco_chan(&ui->trigger_buf[c]);
 #endif
     free_sco_chan(&ui->chn[c]);
     free_sco_chan(&ui->mem[c]);
+    free_sco_snap(&ui->snap[c]);
+    free_layer(&ui->layer[c]);
+#ifdef WITH_PHOSPHOR
+    free_phosphor(&ui->ph[c]);
+#endif
+#ifdef WITH_SPECTRUM
+    free_spec(&ui->spec[c]);
+#endif
+#ifdef WITH_ACQMODES
+    free_sco_chan(&ui->env[c]);
+#endif
+#ifdef WITH_SWEEPAVG
+    free_sco_chan(&ui->avg[c]);
+    free_sco_chan(&ui->avg_sum[c]);
+#endif
+#ifdef WITH_PYRAMID
+    free_pyramid(&ui->pyr[c]);
+#endif
+#ifdef WITH_DEEPMEM
+    free_deep(&ui->deep[c]);
+#endif
+  }
 #ifdef WITH_RESAMPLING
-    delete ui->src[c];
+  free_src_cache(ui);
+  for (uint32_t c = 0; c < ui->n_channels; ++c) {
+    free(ui->src_buf[c]);
+  }
 #endif
+#ifdef WITH_XYMODE
+  for (uint32_t p = 0; p < ui->n_channels / 2; ++p) {
+    free_xy(&ui->xy[p]);
   }
+#endif
+#ifdef WITH_SPECTRUM
+  sco_fft_free(&ui->fft);
+  free(ui->fft_win);
+  free(ui->fft_in);
+  free(ui->fft_col);
+#endif
+#ifdef WITH_SEGMENTS
+  free_segments(ui);
+#endif
+  pthread_mutex_destroy(&ui->resize_lock);
   cairo_surface_destroy(ui->gridnlabels);
   pango_font_description_free(ui->font[0]);
   pango_font_description_free(ui->font[1]);
@@ -2814,10 +6328,24 @@ cleanup(LV2UI_Handle handle)
   robtk_spin_destroy(ui->spb_trigger_lvl);
   robtk_spin_destroy(ui->spb_trigger_pos);
   robtk_spin_destroy(ui->spb_trigger_hld);
+#ifdef WITH_SWEEPAVG
+  robtk_select_destroy(ui->sel_trigger_avg);
+#endif
+#ifdef WITH_SEGMENTS
+  robtk_select_destroy(ui->sel_seg_num);
+  robtk_spin_destroy(ui->spb_seg_show);
+  robtk_lbl_destroy(ui->lbl_tshow);
+#endif
   robtk_pbtn_destroy(ui->btn_trigger_man);
   robtk_lbl_destroy(ui->lbl_tpos);
   robtk_lbl_destroy(ui->lbl_tlvl);
   robtk_lbl_destroy(ui->lbl_thld);
+  robtk_lbl_destroy(ui->lbl_tpar);
+  robtk_spin_destroy(ui->spb_trigger_par);
+  robtk_select_destroy(ui->sel_trigger_kind);
+  robtk_lbl_destroy(ui->lbl_thys);
+  robtk_spin_destroy(ui->spb_trigger_hys);
+  robtk_select_destroy(ui->sel_trigger_hfr);
   robtk_select_destroy(ui->sel_trigger_mode);
   robtk_select_destroy(ui->sel_trigger_type);
 #endif
@@ -2851,6 +6379,18 @@ cleanup(LV2UI_Handle handle)
   robtk_sep_destroy(ui->sep[2]);
 
   robtk_select_destroy(ui->sel_speed);
+  robtk_select_destroy(ui->sel_display);
+#ifdef WITH_ACQMODES
+  robtk_select_destroy(ui->sel_acq);
+#endif
+#ifdef WITH_DEEPMEM
+  robtk_select_destroy(ui->sel_deep);
+#endif
+#ifdef WITH_SPECTRUM
+  robtk_select_destroy(ui->sel_fft_size);
+  robtk_select_destroy(ui->sel_fft_avg);
+  robtk_cbtn_destroy(ui->btn_fft_peak);
+#endif
   robtk_cbtn_destroy(ui->btn_latch);
   robtk_cbtn_destroy(ui->btn_align);
   robtk_cbtn_destroy(ui->btn_pause);
@@ -2858,6 +6398,9 @@ cleanup(LV2UI_Handle handle)
 #ifdef DEBUG_WAVERENDER
   robtk_cbtn_destroy(ui->btn_solidwave);
 #endif
+#ifdef WITH_PROFILING
+  robtk_cbtn_destroy(ui->btn_profile);
+#endif
 #ifdef WITH_TIME_ADJ
   robtk_spin_destroy(ui->spb_speed_adj);
 #endif
@@ -2877,7 +6420,8 @@ cleanup(LV2UI_Handle handle)
  * this callback runs in the "communication" thread of the LV2-host
  * jalv and ardour do this via a g_timeout() function at ~25fps
  * g_timeout is the same thread a the UI display (no locking is needed)
- * but the openGL version does not use lv2idle and requires locking.
+ * but the openGL version does not use lv2idle. Display data is handed
+ * over to the drawing thread via lock-free triple-buffers (ScoSnap).
  *
  * the atom-events from the DSP backend are written into a ringbuffer
  * in the host (in the DSP|jack realtime thread) the host then
@@ -2916,12 +6460,15 @@ port_event(LV2UI_Handle handle,
     LV2_Atom *a3 = NULL;
     LV2_Atom *a4 = NULL;
     LV2_Atom *a5 = NULL;
+    LV2_Atom *a6 = NULL;
     if (
 	/* handle raw-audio data objects */
 	obj->body.otype == ui->uris.rawaudio
 	/* retrieve properties from object and
 	 * check that there the [here] two required properties are set.. */
-	&& 2 == lv2_atom_object_get(obj, ui->uris.channelid, &a0, ui->uris.audiodata, &a1, NULL)
+	&& 2 <= lv2_atom_object_get(obj, ui->uris.channelid, &a0, ui->uris.audiodata, &a1,
+	  ui->uris.trigger, &a2, ui->uris.sequence, &a3, ui->uris.samplepos, &a4,
+	  ui->uris.runtime, &a6, NULL)
 	/* ..and non-null.. */
 	&& a0
 	&& a1
@@ -2942,10 +6489,64 @@ port_event(LV2UI_Handle handle,
 	const size_t n_elem = (a1->size - sizeof(LV2_Atom_Vector_Body)) / vof->atom.size;
 	/* typecast, dereference pointer to vector */
 	const float *data = (float*) LV2_ATOM_BODY(&vof->atom);
+#ifdef WITH_DSP_TRIGGER
+	/* optional: first chunk of a window captured by the DSP trigger,
+	 * -1 on an empty vector: the DSP trigger gave up */
+	const bool dt_abort = a2 && a2->type == ui->uris.atom_Int && ((LV2_Atom_Int*)a2)->body < 0;
+	if (chn >= 0 && chn < (int32_t)ui->n_channels) {
+	  ui->trigger_win[chn] = a2 && a2->type == ui->uris.atom_Int && !dt_abort;
+	}
+	if (dt_abort) {
+	  ui->trigger_abort = true;
+	}
+#endif
+	const uint64_t gap = rx_stamp(ui, chn, a3, a4, n_elem);
+	if (a6 && a6->type == ui->uris.atom_Long) {
+	  prof_add(ui, PROF_RUN, ((LV2_Atom_Long*)a6)->body);
+	}
 	/* call function that handles the actual data */
-	update_scope(ui, chn, n_elem, data);
+	/* never wait for the GUI, skip data while resizing */
+	if (pthread_mutex_trylock(&ui->resize_lock) == 0) {
+	  fill_gap(ui, chn, gap);
+#ifdef WITH_DSP_TRIGGER
+	  /* not audio, the channel is not idle */
+	  if (!dt_abort)
+#endif
+	  update_scope(ui, chn, n_elem, data, 0);
+	  pthread_mutex_unlock(&ui->resize_lock);
+	}
+      }
+    }
+#ifdef WITH_DECIMATION
+    else if (
+	/* handle pre-processed min/max/rms columns */
+	obj->body.otype == ui->uris.decimated
+	&& 3 <= lv2_atom_object_get(obj, ui->uris.channelid, &a0, ui->uris.ui_state_stride, &a1, ui->uris.audiodata, &a2,
+	  ui->uris.sequence, &a3, ui->uris.samplepos, &a4, ui->uris.runtime, &a6, NULL)
+	&& a0 && a1 && a2
+	&& a0->type == ui->uris.atom_Int
+	&& a1->type == ui->uris.atom_Int
+	&& a2->type == ui->uris.atom_Vector
+	)
+    {
+      const int32_t chn = ((LV2_Atom_Int*)a0)->body;
+      const int32_t stride = ((LV2_Atom_Int*)a1)->body;
+      LV2_Atom_Vector* vof = (LV2_Atom_Vector*)LV2_ATOM_BODY(a2);
+      if (vof->atom.type == ui->uris.atom_Float && stride > 0) {
+	const size_t n_elem = (a2->size - sizeof(LV2_Atom_Vector_Body)) / vof->atom.size;
+	const float *data = (float*) LV2_ATOM_BODY(&vof->atom);
+	const uint64_t gap = rx_stamp(ui, chn, a3, a4, (n_elem / 3) * stride);
+	if (a6 && a6->type == ui->uris.atom_Long) {
+	  prof_add(ui, PROF_RUN, ((LV2_Atom_Long*)a6)->body);
+	}
+	if (pthread_mutex_trylock(&ui->resize_lock) == 0) {
+	  fill_gap(ui, chn, gap);
+	  update_scope(ui, chn, n_elem, data, stride);
+	  pthread_mutex_unlock(&ui->resize_lock);
+	}
       }
     }
+#endif
     else if (
 	/* handle 'state/settings' data object */
 	obj->body.otype == ui->uris.ui_state
@@ -2966,6 +6567,14 @@ port_event(LV2UI_Handle handle,
       if (a3 && a3->type == ui->uris.atom_Float) {
 	float rate = ((LV2_Atom_Float*)a3)->body;
 	if (rate > 0) {
+#ifdef WITH_DEEPMEM
+	  if (rate != ui->rate) {
+	    pthread_mutex_lock(&ui->resize_lock);
+	    ui->rate = rate;
+	    setup_deep_memory(ui);
+	    pthread_mutex_unlock(&ui->resize_lock);
+	  }
+#endif
 	  ui->rate = ((LV2_Atom_Float*)a3)->body;
 	  ui->error = false;
 	} else {
@@ -2981,11 +6590,35 @@ port_event(LV2UI_Handle handle,
 	const int32_t misc = ((LV2_Atom_Int*)a4)->body;
 	robtk_cbtn_set_active(ui->btn_latch, 1 == (misc & 1));
 	robtk_cbtn_set_active(ui->btn_align, 2 == (misc & 2));
+	robtk_select_set_value(ui->sel_display, (misc >> 2) & 7);
+#ifdef WITH_SPECTRUM
+	if ((misc >> 5) & 7) {
+	  robtk_select_set_item(ui->sel_fft_size, ((misc >> 5) & 7) - 1);
+	}
+	if ((misc >> 8) & 3) {
+	  robtk_select_set_item(ui->sel_fft_avg, ((misc >> 8) & 3) - 1);
+	}
+#endif
+#ifdef WITH_ACQMODES
+	robtk_select_set_value(ui->sel_acq, (misc >> 10) & 3);
+#endif
+#ifdef WITH_SWEEPAVG
+	robtk_select_set_item(ui->sel_trigger_avg, MIN(8, (misc >> 12) & 15));
+#endif
+#ifdef WITH_SEGMENTS
+	if ((misc >> 16) & 7) {
+	  robtk_select_set_item(ui->sel_seg_num, MIN(4, ((misc >> 16) & 7) - 1));
+	}
+#endif
+#ifdef WITH_DEEPMEM
+	robtk_select_set_item(ui->sel_deep, (misc >> 19) & 3);
+#endif
       }
 
 #ifdef WITH_TRIGGER
-      if (a2 && a2->type == ui->uris.atom_Vector) {
-	apply_state_trig(ui, (LV2_Atom_Vector*)LV2_ATOM_BODY(a2));
+      if (a2 && a2->type == ui->uris.atom_Vector && a2->size > sizeof(LV2_Atom_Vector_Body)) {
+	apply_state_trig(ui, (LV2_Atom_Vector*)LV2_ATOM_BODY(a2),
+	    a2->size - sizeof(LV2_Atom_Vector_Body));
       }
 #endif
 #ifdef WITH_MARKERS
@@ -24,6 +24,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <time.h>
 
 #ifdef HAVE_LV2_1_18_6
 #include <lv2/core/lv2.h>
@@ -34,6 +35,14 @@
 #endif
 
 #include "./uris.h"
+#include "./trigger.h"
+
+#ifndef MIN
+#define MIN(A,B) ( (A) < (B) ? (A) : (B) )
+#endif
+#ifndef MAX
+#define MAX(A,B) ( (A) > (B) ? (A) : (B) )
+#endif
 
 
 typedef struct {
@@ -52,6 +61,10 @@ typedef struct {
   uint32_t n_channels;
   double rate;
 
+  /* message stamps, see tx_stamp() */
+  uint64_t sample_pos;
+  uint32_t tx_seq[MAX_CHANNELS];
+
   /* the state of the UI is stored here, so that
    * the GUI can be displayed & closed
    * without loosing current settings.
@@ -67,8 +80,57 @@ typedef struct {
   struct triggerstate triggerstate;
   struct cursorstate cursorstate;
 
+  /* DSP-side decimation, requested by the UI.
+   * 0: send raw audio, otherwise send min/max/rms
+   * columns of decim_stride samples each.
+   */
+  uint32_t decim_stride;
+  uint32_t decim_sub[MAX_CHANNELS];
+  float    decim_min[MAX_CHANNELS];
+  float    decim_max[MAX_CHANNELS];
+  float    decim_rms[MAX_CHANNELS];
+
+  /* channels the UI displays or triggers on (bitmask).
+   * If none, only a periodic heartbeat is sent,
+   * so that the UI can resume.
+   */
+  uint32_t ui_want;
+  uint32_t heartbeat;
+
+  /* DSP-side trigger, armed by the UI.
+   * While armed, audio is only recorded into a ring-buffer,
+   * once triggered the pre- and post-trigger window is sent.
+   */
+  int      dt_state;
+  float   *dt_ring[MAX_CHANNELS];
+  uint32_t dt_wpos;   // ring-buffer write position
+  uint32_t dt_fill;   // valid samples in the ring-buffer
+  uint32_t dt_pre;    // samples to send before the trigger-point
+  uint32_t dt_post;   // samples to send after the trigger-point
+  uint32_t dt_rpos;   // read position of the window
+  uint64_t dt_rabs;   // sample-position of dt_rpos
+  uint32_t dt_avail;  // samples recorded but not yet sent
+  uint32_t dt_remain; // samples of the window yet to send
+  bool     dt_start;  // next chunk starts the window
+  bool     dt_abort;  // tell the UI that the DSP trigger gave up
+  ScoTrigger dt_trig;
+
+  /* profiling, requested by the UI: duration of the previous run() */
+  bool     profile;
+  uint64_t run_ns;
+
 } SiSco;
 
+/* bytes reserved for the 'ui_state' message to the UI (plus 16 per
+ * channel), the trigger settings vector grows with struct triggerstate */
+#define UI_STATE_SIZE ((uint32_t)(196 + sizeof(struct triggerstate)))
+
+enum {
+  DT_OFF = 0,
+  DT_ARMED,
+  DT_WINDOW,
+};
+
 typedef enum {
   SCO_CONTROL  = 0,
   SCO_NOTIFY   = 1,
@@ -87,6 +149,18 @@ typedef enum {
 } PortIndex;
 
 
+/** reset column accumulators, (re)start decimation with given stride */
+static void set_decimation(SiSco* self, uint32_t stride)
+{
+  self->decim_stride = stride > 1 ? stride : 0;
+  for (uint32_t c = 0; c < self->n_channels; ++c) {
+    self->decim_sub[c] = 0;
+    self->decim_min[c] =  1.0;
+    self->decim_max[c] = -1.0;
+    self->decim_rms[c] =  0;
+  }
+}
+
 static LV2_Handle
 instantiate(const LV2_Descriptor*     descriptor,
             double                    rate,
@@ -129,6 +203,17 @@ instantiate(const LV2_Descriptor*     descriptor,
 
   assert(self->n_channels <= MAX_CHANNELS);
 
+  for (uint32_t c = 0; c < self->n_channels; ++c) {
+    self->dt_ring[c] = (float*) calloc(DSP_TRIGGER_BUFSZ, sizeof(float));
+    if (!self->dt_ring[c]) {
+      for (uint32_t i = 0; i < c; ++i) {
+	free(self->dt_ring[i]);
+      }
+      free(self);
+      return NULL;
+    }
+  }
+
   self->ui_active = false;
   self->send_settings_to_ui = false;
   self->printed_capacity_warning = false;
@@ -141,12 +226,21 @@ instantiate(const LV2_Descriptor*     descriptor,
   self->triggerstate.xpos = 50;
   self->triggerstate.hold = 0.5;
   self->triggerstate.level = 0.0;
+  self->triggerstate.kind = TRIG_EDGE;
+  self->triggerstate.param = 0.5;
+  self->triggerstate.hyst = 0;
+  self->triggerstate.hfrej = 0;
 
   self->cursorstate.xpos[0] = 640 * .25;
   self->cursorstate.xpos[1] = 640 * .75;
   self->cursorstate.chn[0] = 1;
   self->cursorstate.chn[1] = 1;
 
+  set_decimation(self, 0);
+  self->ui_want = ~0;
+  self->heartbeat = 0;
+  self->dt_state = DT_OFF;
+
   for (uint32_t c = 0; c < self->n_channels; ++c) {
     self->channelstate[c].gain = 1.0;
     self->channelstate[c].xoff = 0.0;
@@ -185,11 +279,57 @@ connect_port(LV2_Handle handle,
   }
 }
 
-/** forge atom-vector of raw data */
-static void tx_rawaudio(LV2_Atom_Forge *forge, ScoLV2URIs *uris,
-    const int32_t channel, const size_t n_samples, void *data)
+/** like lv2_atom_forge_raw() but leave it to the caller to fill in the data.
+ * returns NULL if the buffer is full. */
+static void* x_forge_reserve(LV2_Atom_Forge *forge, const uint32_t size)
+{
+  if (forge->sink || forge->offset + size > forge->size) {
+    return NULL;
+  }
+  void *mem = forge->buf + forge->offset;
+  forge->offset += size;
+  for (LV2_Atom_Forge_Frame* f = forge->stack; f; f = f->parent) {
+    lv2_atom_forge_deref(forge, f->ref)->size += size;
+  }
+  return mem;
+}
+
+/** add the channel's message sequence-number and the
+ * sample-position of the message's first sample.
+ * The UI uses this to detect and fill-in lost messages.
+ */
+static void tx_stamp(SiSco* self, const int32_t channel, const uint64_t pos)
+{
+  lv2_atom_forge_property_head(&self->forge, self->uris.sequence, 0);
+  lv2_atom_forge_int(&self->forge, self->tx_seq[channel]++);
+  lv2_atom_forge_property_head(&self->forge, self->uris.samplepos, 0);
+  lv2_atom_forge_long(&self->forge, pos);
+  if (self->profile && channel == 0 && self->run_ns > 0) {
+    lv2_atom_forge_property_head(&self->forge, self->uris.runtime, 0);
+    lv2_atom_forge_long(&self->forge, self->run_ns);
+  }
+}
+
+static inline uint64_t clock_ns(void)
 {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/** forge atom-vector of raw data.
+ * The samples are written directly into the atom-sequence, in the
+ * same pass the audio is forwarded to the output (if not in-place).
+ * n_samples == 0 sends an empty vector (channel is not displayed).
+ */
+static void tx_rawaudio(SiSco* self,
+    const int32_t channel, const size_t n_samples,
+    const float *input, float *output)
+{
+  LV2_Atom_Forge *forge = &self->forge;
+  ScoLV2URIs *uris = &self->uris;
   LV2_Atom_Forge_Frame frame;
+  LV2_Atom_Forge_Frame vframe;
   /* forge container object of type 'rawaudio' */
   lv2_atom_forge_frame_time(forge, 0);
   x_forge_object(forge, &frame, 1, uris->rawaudio);
@@ -197,30 +337,256 @@ static void tx_rawaudio(LV2_Atom_Forge *forge, ScoLV2URIs *uris,
   /* add integer attribute 'channelid' */
   lv2_atom_forge_property_head(forge, uris->channelid, 0);
   lv2_atom_forge_int(forge, channel);
+  tx_stamp(self, channel, self->sample_pos);
 
   /* add vector of floats raw 'audiodata' */
   lv2_atom_forge_property_head(forge, uris->audiodata, 0);
-  lv2_atom_forge_vector(forge, sizeof(float), uris->atom_Float, n_samples, data);
+  lv2_atom_forge_vector_head(forge, &vframe, sizeof(float), uris->atom_Float);
+  float *body = (float*) x_forge_reserve(forge, n_samples * sizeof(float));
+  if (body && input == output) {
+    memcpy(body, input, n_samples * sizeof(float));
+  } else if (body) {
+    for (uint32_t i = 0; i < n_samples; ++i) {
+      body[i] = output[i] = input[i];
+    }
+  }
+  lv2_atom_forge_pop(forge, &vframe);
+  lv2_atom_forge_pad(forge, n_samples * sizeof(float));
 
   /* close off atom-object */
   lv2_atom_forge_pop(forge, &frame);
+
+  /* buffer overflow, forward audio nevertheless */
+  if (!body && input != output && n_samples > 0) {
+    memcpy(output, input, sizeof(float) * n_samples);
+  }
+}
+
+/** the UI displays the channel, or uses it as trigger-source */
+static bool channel_wanted(const SiSco* self, const uint32_t c)
+{
+  return (self->ui_want >> c) & 1;
+}
+
+/** forge atom-vector of decimated data:
+ * [min, max, sum of squares] for every complete column.
+ * Partial columns are kept and completed in the next cycle.
+ */
+static void tx_decimated(SiSco* self, const int32_t channel,
+    const uint32_t n_samples, const float *data)
+{
+  LV2_Atom_Forge *forge = &self->forge;
+  ScoLV2URIs *uris = &self->uris;
+  const uint32_t stride = self->decim_stride;
+
+  uint32_t sub = self->decim_sub[channel];
+  float d_min  = self->decim_min[channel];
+  float d_max  = self->decim_max[channel];
+  float d_rms  = self->decim_rms[channel];
+
+  const uint32_t n_cols = (sub + n_samples) / stride;
+  LV2_Atom_Forge_Frame frame;
+  LV2_Atom_Forge_Frame vframe;
+
+  if (n_cols > 0) {
+    /* forge container object of type 'decimated' */
+    lv2_atom_forge_frame_time(forge, 0);
+    x_forge_object(forge, &frame, 1, uris->decimated);
+
+    lv2_atom_forge_property_head(forge, uris->channelid, 0);
+    lv2_atom_forge_int(forge, channel);
+    /* the first column started in a previous cycle */
+    tx_stamp(self, channel, self->sample_pos - sub);
+
+    /* the UI discards columns that do not match its stride */
+    lv2_atom_forge_property_head(forge, uris->ui_state_stride, 0);
+    lv2_atom_forge_int(forge, stride);
+
+    /* vector of float triplets, filled column by column */
+    lv2_atom_forge_property_head(forge, uris->audiodata, 0);
+    lv2_atom_forge_vector_head(forge, &vframe, sizeof(float), uris->atom_Float);
+  }
+
+  for (uint32_t i = 0; i < n_samples; ++i) {
+    if (data[i] < d_min) { d_min = data[i]; }
+    if (data[i] > d_max) { d_max = data[i]; }
+    d_rms += data[i] * data[i];
+    if (++sub >= stride) {
+      const float col[3] = { d_min, d_max, d_rms };
+      lv2_atom_forge_raw(forge, col, sizeof(col));
+      sub = 0;
+      d_min =  1.0;
+      d_max = -1.0;
+      d_rms =  0;
+    }
+  }
+
+  if (n_cols > 0) {
+    lv2_atom_forge_pop(forge, &vframe);
+    lv2_atom_forge_pad(forge, n_cols * 3 * sizeof(float));
+    /* close off atom-object */
+    lv2_atom_forge_pop(forge, &frame);
+  }
+
+  self->decim_sub[channel] = sub;
+  self->decim_min[channel] = d_min;
+  self->decim_max[channel] = d_max;
+  self->decim_rms[channel] = d_rms;
+}
+
+/** (re)arm the DSP trigger, pre + post == 0 disarms it */
+static void dt_arm(SiSco* self, const uint32_t pre, const uint32_t post)
+{
+  if (pre + post == 0 || pre > DSP_TRIGGER_BUFSZ / 2) {
+    self->dt_abort = pre + post > 0;
+    self->dt_state = DT_OFF;
+    return;
+  }
+  self->dt_state = DT_ARMED;
+  self->dt_pre = pre;
+  self->dt_post = post;
+  self->dt_wpos = 0;
+  self->dt_fill = 0;
+  sco_trigger_config(&self->dt_trig, self->triggerstate.kind,
+      ((int)self->triggerstate.type) & 1,
+      self->triggerstate.level, self->triggerstate.param,
+      self->triggerstate.hyst, self->triggerstate.hfrej, self->rate);
+  sco_trigger_reset(&self->dt_trig, self->triggerstate.level);
+}
+
+/** append the current cycle to the ring-buffer */
+static void dt_record(SiSco* self, const uint32_t n_samples)
+{
+  const uint32_t n0 = MIN(n_samples, DSP_TRIGGER_BUFSZ - self->dt_wpos);
+  for (uint32_t c = 0; c < self->n_channels; ++c) {
+    memcpy(&self->dt_ring[c][self->dt_wpos], self->input[c], n0 * sizeof(float));
+    memcpy(self->dt_ring[c], &self->input[c][n0], (n_samples - n0) * sizeof(float));
+  }
+  self->dt_wpos = (self->dt_wpos + n_samples) & (DSP_TRIGGER_BUFSZ - 1);
+}
+
+/** look for the trigger in the current cycle,
+ * must be called before dt_record() */
+static void dt_detect(SiSco* self, const uint32_t n_samples)
+{
+  const uint32_t chn = ((int)self->triggerstate.type) >> 1;
+  if (chn >= self->n_channels) {
+    return;
+  }
+
+  /* the pre-trigger window must be complete */
+  const uint32_t from = self->dt_fill >= self->dt_pre ? 0 : self->dt_pre - self->dt_fill;
+  const int32_t i = sco_trigger_scan(&self->dt_trig, self->input[chn], n_samples, from);
+  if (i >= 0) {
+    /* align the window to the sample nearest to the crossing */
+    const int32_t at = MAX((int32_t) lrint(self->dt_trig.cross),
+	(int32_t) self->dt_pre - (int32_t) self->dt_fill);
+    self->dt_state = DT_WINDOW;
+    self->dt_rpos = (self->dt_wpos + at - self->dt_pre) & (DSP_TRIGGER_BUFSZ - 1);
+    self->dt_rabs = self->sample_pos + at - self->dt_pre;
+    self->dt_avail = self->dt_pre + n_samples - at;
+    self->dt_remain = self->dt_pre + self->dt_post;
+    self->dt_start = true;
+  }
+  self->dt_fill = MIN(DSP_TRIGGER_BUFSZ, self->dt_fill + n_samples);
+}
+
+/** forge a chunk of the triggered window */
+static void tx_window(SiSco* self, const int32_t channel,
+    const uint32_t n_samples, const float *data)
+{
+  LV2_Atom_Forge *forge = &self->forge;
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(forge, 0);
+  x_forge_object(forge, &frame, 1, self->uris.rawaudio);
+
+  lv2_atom_forge_property_head(forge, self->uris.channelid, 0);
+  lv2_atom_forge_int(forge, channel);
+  tx_stamp(self, channel, self->dt_rabs);
+
+  if (self->dt_start) {
+    lv2_atom_forge_property_head(forge, self->uris.trigger, 0);
+    lv2_atom_forge_int(forge, self->dt_pre);
+  }
+
+  lv2_atom_forge_property_head(forge, self->uris.audiodata, 0);
+  lv2_atom_forge_vector(forge, sizeof(float), self->uris.atom_Float, n_samples, data);
+
+  lv2_atom_forge_pop(forge, &frame);
+}
+
+/* size of an abort message, plus 24 on channel 0 while profiling */
+#define DT_ABORT_SIZE (144)
+
+/** an empty chunk with trigger = -1: the UI falls back to its own trigger */
+static void tx_abort(SiSco* self, const int32_t channel)
+{
+  LV2_Atom_Forge *forge = &self->forge;
+  LV2_Atom_Forge_Frame frame;
+  lv2_atom_forge_frame_time(forge, 0);
+  x_forge_object(forge, &frame, 1, self->uris.rawaudio);
+
+  lv2_atom_forge_property_head(forge, self->uris.channelid, 0);
+  lv2_atom_forge_int(forge, channel);
+  tx_stamp(self, channel, self->sample_pos);
+
+  lv2_atom_forge_property_head(forge, self->uris.trigger, 0);
+  lv2_atom_forge_int(forge, -1);
+
+  lv2_atom_forge_property_head(forge, self->uris.audiodata, 0);
+  lv2_atom_forge_vector(forge, sizeof(float), self->uris.atom_Float, 0, NULL);
+
+  lv2_atom_forge_pop(forge, &frame);
+}
+
+/** send as much of the triggered window as the buffer allows */
+static void dt_send(SiSco* self, const uint32_t budget)
+{
+  if (self->dt_avail > DSP_TRIGGER_BUFSZ) {
+    /* the ring-buffer was overwritten before it could be sent */
+    self->dt_state = DT_OFF;
+    self->dt_abort = true;
+    return;
+  }
+  uint32_t n = MIN(self->dt_remain, self->dt_avail);
+  n = MIN(n, budget);
+  n = MIN(n, DSP_TRIGGER_BUFSZ - self->dt_rpos);
+
+  for (uint32_t c = 0; c < self->n_channels; ++c) {
+    if (!channel_wanted(self, c)) {
+      tx_rawaudio(self, c, 0, NULL, NULL);
+    } else {
+      tx_window(self, c, n, &self->dt_ring[c][self->dt_rpos]);
+    }
+  }
+
+  self->dt_start = false;
+  self->dt_rpos = (self->dt_rpos + n) & (DSP_TRIGGER_BUFSZ - 1);
+  self->dt_rabs += n;
+  self->dt_avail -= n;
+  self->dt_remain -= n;
+  if (self->dt_remain == 0) {
+    self->dt_state = DT_OFF;
+  }
 }
 
 static void
 run(LV2_Handle handle, uint32_t n_samples)
 {
   SiSco* self = (SiSco*)handle;
-  const uint32_t size = (sizeof(float) * n_samples + 80) * self->n_channels;
+  const uint64_t t_start = self->profile ? clock_ns() : 0;
+  const uint32_t size = (sizeof(float) * n_samples + 128) * self->n_channels
+    + (self->profile ? 24 : 0);
   const uint32_t capacity = self->notify->atom.size;
   bool capacity_ok = true;
 
   /* check if atom-port buffer is large enough to hold
    * all audio-samples and configuration settings */
-  if (capacity < size + 216 + self->n_channels * 16) {
+  if (capacity < size + UI_STATE_SIZE + self->n_channels * 16) {
     capacity_ok = false;
     if (!self->printed_capacity_warning) {
       fprintf(stderr, "SiSco.lv2 error: LV2 comm-buffersize is insufficient %d/%d bytes.\n",
-	  capacity, size + 216 + self->n_channels * 16);
+	  capacity, size + UI_STATE_SIZE + self->n_channels * 16);
       self->printed_capacity_warning = true;
     }
   }
@@ -275,9 +641,18 @@ run(LV2_Handle handle, uint32_t n_samples)
 	  /* UI was activated */
 	  self->ui_active = true;
 	  self->send_settings_to_ui = true;
+	  self->ui_want = ~0;
+	  self->dt_state = DT_OFF;
+	  self->dt_abort = false;
+	  self->profile = false;
+	  set_decimation(self, 0);
 	} else if (obj->body.otype == self->uris.ui_off) {
 	  /* UI was closed */
 	  self->ui_active = false;
+	  self->dt_state = DT_OFF;
+	  self->dt_abort = false;
+	  self->profile = false;
+	  set_decimation(self, 0);
 	} else if (obj->body.otype == self->uris.ui_state) {
 	  /* UI sends current settings */
 	  const LV2_Atom* grid = NULL;
@@ -285,12 +660,20 @@ run(LV2_Handle handle, uint32_t n_samples)
 	  const LV2_Atom* curs = NULL;
 	  const LV2_Atom* misc = NULL;
 	  const LV2_Atom* chn = NULL;
+	  const LV2_Atom* stride = NULL;
+	  const LV2_Atom* want = NULL;
+	  const LV2_Atom* tarm = NULL;
+	  const LV2_Atom* prof = NULL;
 	  lv2_atom_object_get(obj,
 	      self->uris.ui_state_grid, &grid,
 	      self->uris.ui_state_trig, &trig,
 	      self->uris.ui_state_curs, &curs,
 	      self->uris.ui_state_misc, &misc,
 	      self->uris.ui_state_chn, &chn,
+	      self->uris.ui_state_stride, &stride,
+	      self->uris.ui_state_want, &want,
+	      self->uris.ui_state_tarm, &tarm,
+	      self->uris.ui_state_prof, &prof,
 	      0);
 	  if (grid && grid->type == self->uris.atom_Int) {
 	    self->ui_grid = ((LV2_Atom_Int*)grid)->body;
@@ -298,11 +681,27 @@ run(LV2_Handle handle, uint32_t n_samples)
 	  if (misc && misc->type == self->uris.atom_Int) {
 	    self->ui_misc = ((LV2_Atom_Int*)misc)->body;
 	  }
+	  if (stride && stride->type == self->uris.atom_Int) {
+	    const int32_t ds = ((LV2_Atom_Int*)stride)->body;
+	    if (ds != (int32_t)self->decim_stride) {
+	      set_decimation(self, ds > 0 ? ds : 0);
+	    }
+	  }
+	  if (want && want->type == self->uris.atom_Int) {
+	    self->ui_want = ((LV2_Atom_Int*)want)->body;
+	    self->heartbeat = 0;
+	  }
+	  if (prof && prof->type == self->uris.atom_Int) {
+	    self->profile = ((LV2_Atom_Int*)prof)->body != 0;
+	    self->run_ns = 0;
+	  }
 	  if (trig && trig->type == self->uris.atom_Vector) {
 	    LV2_Atom_Vector *vof = (LV2_Atom_Vector*)LV2_ATOM_BODY(trig);
-	    if (vof->atom.type == self->uris.atom_Float) {
+	    const uint32_t len = trig->size - sizeof(LV2_Atom_Vector_Body);
+	    if (vof->atom.type == self->uris.atom_Float
+		&& trig->size >= sizeof(LV2_Atom_Vector_Body) + TRIGGERSTATE_MIN_SIZE) {
 	      struct triggerstate *ts = (struct triggerstate *) LV2_ATOM_BODY(&vof->atom);
-	      memcpy(&self->triggerstate, ts, sizeof(struct triggerstate));
+	      memcpy(&self->triggerstate, ts, MIN(len, sizeof(struct triggerstate)));
 	    }
 	  }
 	  if (curs && curs->type == self->uris.atom_Vector) {
@@ -319,31 +718,113 @@ run(LV2_Handle handle, uint32_t n_samples)
 	      memcpy(self->channelstate, cs, self->n_channels * sizeof(struct channelstate));
 	    }
 	  }
+	  if (tarm && tarm->type == self->uris.atom_Vector) {
+	    LV2_Atom_Vector *vof = (LV2_Atom_Vector*)LV2_ATOM_BODY(tarm);
+	    if (vof->atom.type == self->uris.atom_Int
+		&& tarm->size >= sizeof(LV2_Atom_Vector_Body) + 2 * sizeof(int32_t)) {
+	      const int32_t *pp = (const int32_t*) LV2_ATOM_BODY(&vof->atom);
+	      dt_arm(self, MAX(0, pp[0]), MAX(0, pp[1]));
+	    }
+	  }
 	}
       }
       ev = lv2_atom_sequence_next(ev);
     }
   }
 
+  /* DSP trigger: look for the trigger-point, then send the window */
+  bool dt_cycle = false;
+  bool dt_skip = false;
+  if (self->ui_active && capacity_ok && self->dt_state != DT_OFF
+      && n_samples <= DSP_TRIGGER_BUFSZ / 2) {
+    /* the window may catch up with whatever space is left in the buffer,
+     * less the 'trigger' property of the first chunk (24 bytes/channel) */
+    const uint32_t spare = n_samples
+      + (capacity - size - UI_STATE_SIZE - self->n_channels * 16) / (self->n_channels * sizeof(float));
+    const uint32_t budget = spare - MIN(spare, 24 / sizeof(float));
+    if (self->dt_state == DT_ARMED) {
+      dt_detect(self, n_samples);
+    } else {
+      self->dt_avail += n_samples;
+    }
+    dt_record(self, n_samples);
+    if (self->dt_state == DT_WINDOW) {
+      dt_send(self, budget);
+    }
+    dt_cycle = true;
+  } else if (self->dt_state != DT_OFF) {
+    /* the window would not fit into the buffer,
+     * or the cycle would wrap around the ring-buffer */
+    self->dt_state = DT_OFF;
+    self->dt_abort = true;
+  }
+  if (self->dt_abort && self->ui_active) {
+    self->dt_abort = false;
+    /* if the abort messages and this cycle's audio do not both fit,
+     * the abort replaces the audio (the UI restarts the capture anyway) */
+    dt_skip = !dt_cycle
+      && capacity < size + UI_STATE_SIZE + self->n_channels * (16 + DT_ABORT_SIZE) + (self->profile ? 24 : 0);
+    for (uint32_t c = 0; c < self->n_channels; ++c) {
+      tx_abort(self, c);
+    }
+  }
+
+  /* nothing is displayed (paused, no trigger armed) or waiting for
+   * the DSP trigger: only send empty messages every 40ms,
+   * to keep the UI polling */
+  bool heartbeat = false;
+  if (self->ui_active && (self->ui_want == 0 || self->dt_state == DT_ARMED)) {
+    self->heartbeat += n_samples;
+    if (self->heartbeat >= self->rate / 25) {
+      self->heartbeat = 0;
+      heartbeat = true;
+    }
+  }
+
   /* process audio data */
   for (uint32_t c = 0; c < self->n_channels; ++c) {
-    if (self->ui_active && capacity_ok) {
-      /* if UI is active, send raw audio data to UI */
-      tx_rawaudio(&self->forge, &self->uris, c, n_samples, self->input[c]);
+    bool forwarded = false;
+    if (dt_cycle) {
+      if (heartbeat && self->dt_state == DT_ARMED) {
+	tx_rawaudio(self, c, 0, NULL, NULL);
+      }
+    } else if (self->ui_active && capacity_ok && !dt_skip) {
+      if (!channel_wanted(self, c)) {
+	/* keep the UI's per-channel sequence, but no data */
+	if (self->ui_want != 0 || heartbeat) {
+	  tx_rawaudio(self, c, 0, NULL, NULL);
+	}
+      } else if (self->decim_stride > 0) {
+	/* send min/max/rms columns, as requested by the UI */
+	tx_decimated(self, c, n_samples, self->input[c]);
+      } else {
+	/* if UI is active, send raw audio data to UI and forward audio */
+	tx_rawaudio(self, c, n_samples, self->input[c], self->output[c]);
+	forwarded = true;
+      }
     }
     /* if not processing in-place, forward audio */
-    if (self->input[c] != self->output[c]) {
+    if (!forwarded && self->input[c] != self->output[c]) {
       memcpy(self->output[c], self->input[c], sizeof(float) * n_samples);
     }
   }
 
   /* close off atom-sequence */
   lv2_atom_forge_pop(&self->forge, &self->frame);
+  self->sample_pos += n_samples;
+
+  if (t_start > 0) {
+    self->run_ns = clock_ns() - t_start;
+  }
 }
 
 static void
 cleanup(LV2_Handle handle)
 {
+  SiSco* self = (SiSco*)handle;
+  for (uint32_t c = 0; c < self->n_channels; ++c) {
+    free(self->dt_ring[c]);
+  }
   free(handle);
 }
 
@@ -434,10 +915,12 @@ state_restore(
   }
 
   value = retrieve(handle, self->uris.ui_state_trig, &size, &type, &valflags);
+  /* older versions saved fewer members, keep the defaults of the rest */
   if (value
-      && size == sizeof(LV2_Atom_Vector_Body) + sizeof(struct triggerstate)
+      && size >= sizeof(LV2_Atom_Vector_Body) + TRIGGERSTATE_MIN_SIZE
       && type == self->uris.atom_Vector) {
-    memcpy(&self->triggerstate, LV2_ATOM_BODY(value), sizeof(struct triggerstate));
+    memcpy(&self->triggerstate, LV2_ATOM_BODY(value),
+	MIN(size - sizeof(LV2_Atom_Vector_Body), sizeof(struct triggerstate)));
     self->send_settings_to_ui = true;
   }
 
@@ -0,0 +1,343 @@
+/* simple scope -- trigger detection, shared by DSP and UI
+ *
+ * Copyright (C) 2013 Robin Gareus <robin@gareus.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCO_TRIGGER_H
+#define SCO_TRIGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* trigger kinds, saved in triggerstate.kind */
+enum ScoTriggerKind {
+  TRIG_EDGE = 0,
+  TRIG_PULSE_GT,   // pulse wider than 'param' [ms], at its trailing edge
+  TRIG_PULSE_LT,   // pulse narrower than 'param' [ms], at its trailing edge
+  TRIG_SLOPE,      // dV/dt of at least 'param' [full-scale/ms]
+  TRIG_WINDOW_EXIT,  // leave the band level +/- 'param'
+  TRIG_WINDOW_ENTER, // enter the band level +/- 'param'
+  TRIG_RUNT,       // pulse that crosses level, but not level + 'param'
+  TRIG_KINDS
+};
+
+/* All kinds, except slope, only change their state when the signal
+ * moves between the zones below 'lo', between 'lo' and 'hi' and
+ * above 'hi'. Those transitions are found with a vectorized scan,
+ * only the (few) transitions are evaluated one by one.
+ * The falling polarity is handled by negating signal and thresholds.
+ *
+ * Edge and pulse triggers use 'lo' as hysteresis: the signal has to
+ * drop below level - hysteresis before the next edge counts.
+ * The optional HF-reject low-pass only affects the trigger path.
+ */
+typedef struct {
+  /* configuration, see sco_trigger_config() */
+  int      kind;
+  float    sgn;    // +1: rising, -1: falling
+  float    lo, hi; // zone thresholds, multiplied by sgn
+  float    slope;  // minimum of sgn * dV per sample
+  uint64_t width;  // pulse-width in samples
+  float    lpf;    // HF-reject low-pass coefficient, 0: off
+  float    delay;  // group-delay of the low-pass in samples
+  /* state */
+  float    prev;   // previous (filtered) sample
+  float    lpz;    // low-pass state
+  int      zone;   // zone of prev
+  bool     high;   // schmitt-trigger output
+  bool     armed;  // a pulse or runt is in progress
+  uint64_t start;  // start of the pulse
+  uint64_t pos;    // samples since sco_trigger_reset()
+  double   cross;  // interpolated position of the last trigger
+} ScoTrigger;
+
+#define SCO_TRIGGER_CHUNK 64
+
+/** 'hyst' is in signal units, 'hfreject' is the low-pass cutoff in Hz,
+ * 0 to disable */
+static void
+sco_trigger_config (ScoTrigger *t, const int kind, const bool falling,
+    const float level, const float param, const float hyst,
+    const float hfreject, const double rate)
+{
+  float lo = level;
+  float hi = level;
+  t->kind = (kind >= 0 && kind < TRIG_KINDS) ? kind : TRIG_EDGE;
+  t->sgn = falling ? -1.f : 1.f;
+  switch (t->kind) {
+    case TRIG_WINDOW_EXIT:
+    case TRIG_WINDOW_ENTER:
+      t->sgn = 1.f;
+      lo = level - param;
+      hi = level + param;
+      break;
+    case TRIG_RUNT:
+      hi = level + t->sgn * param;
+      break;
+    case TRIG_EDGE:
+    case TRIG_PULSE_GT:
+    case TRIG_PULSE_LT:
+      lo = level - t->sgn * (hyst > 0 ? hyst : 0);
+      break;
+    default:
+      break;
+  }
+  if (t->sgn < 0) {
+    /* -x >= -v  <=>  x <= v */
+    t->lo = -(lo > hi ? lo : hi);
+    t->hi = -(lo > hi ? hi : lo);
+  } else {
+    t->lo = lo;
+    t->hi = hi;
+  }
+  t->slope = param * 1e3 / rate;
+  t->width = param > 0 ? param * 1e-3 * rate : 0;
+  if (hfreject > 0 && hfreject < .25 * rate) {
+    t->lpf = 1.0 - exp (-6.283185307179586 * hfreject / rate);
+    t->delay = (1.f - t->lpf) / t->lpf;
+  } else {
+    t->lpf = 0;
+    t->delay = 0;
+  }
+}
+
+static inline int
+sco_trigger_zone (const ScoTrigger *t, const float x)
+{
+  const float v = t->sgn * x;
+  return (v >= t->lo) + (v >= t->hi);
+}
+
+/** start over, 'prev' is the sample before the first one to scan */
+static void
+sco_trigger_reset (ScoTrigger *t, const float prev)
+{
+  t->prev = prev;
+  t->lpz = prev;
+  t->zone = sco_trigger_zone (t, prev);
+  t->high = t->zone == 2;
+  t->armed = false;
+  t->start = 0;
+  t->pos = 0;
+}
+
+/** index of the first sample whose zone differs from the previous one, or n */
+static uint32_t
+sco_find_zone_change (const float *d, const uint32_t n, const float prev,
+    const float sgn, const float lo, const float hi)
+{
+  if (n == 0) {
+    return 0;
+  }
+  const float p = sgn * prev;
+  const float x = sgn * d[0];
+  if ((p >= lo) != (x >= lo) || (p >= hi) != (x >= hi)) {
+    return 0;
+  }
+  uint32_t i = 1;
+#ifdef __SSE2__
+  const __m128 vs = _mm_set1_ps (sgn);
+  const __m128 vl = _mm_set1_ps (lo);
+  const __m128 vh = _mm_set1_ps (hi);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 a = _mm_mul_ps (vs, _mm_loadu_ps (&d[i - 1]));
+    const __m128 b = _mm_mul_ps (vs, _mm_loadu_ps (&d[i]));
+    const __m128 cl = _mm_xor_ps (_mm_cmpge_ps (a, vl), _mm_cmpge_ps (b, vl));
+    const __m128 ch = _mm_xor_ps (_mm_cmpge_ps (a, vh), _mm_cmpge_ps (b, vh));
+    const int m = _mm_movemask_ps (_mm_or_ps (cl, ch));
+    if (m) {
+      return i + __builtin_ctz (m);
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    const float a = sgn * d[i - 1];
+    const float b = sgn * d[i];
+    if ((a >= lo) != (b >= lo) || (a >= hi) != (b >= hi)) {
+      return i;
+    }
+  }
+  return n;
+}
+
+/** index of the first sample with sgn * (d[i] - d[i-1]) >= slope, or n */
+static uint32_t
+sco_find_slope (const float *d, const uint32_t n, const float prev,
+    const float sgn, const float slope)
+{
+  if (n == 0) {
+    return 0;
+  }
+  if (sgn * (d[0] - prev) >= slope) {
+    return 0;
+  }
+  uint32_t i = 1;
+#ifdef __SSE2__
+  const __m128 vs = _mm_set1_ps (sgn);
+  const __m128 vt = _mm_set1_ps (slope);
+  for (; i + 4 <= n; i += 4) {
+    const __m128 dd = _mm_sub_ps (_mm_loadu_ps (&d[i]), _mm_loadu_ps (&d[i - 1]));
+    const int m = _mm_movemask_ps (_mm_cmpge_ps (_mm_mul_ps (vs, dd), vt));
+    if (m) {
+      return i + __builtin_ctz (m);
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    if (sgn * (d[i] - d[i - 1]) >= slope) {
+      return i;
+    }
+  }
+  return n;
+}
+
+/** sub-sample position of the threshold crossing between
+ * d[i-1] (p) and d[i], the zone changed from 'zp' to 'z' */
+static inline double
+sco_trigger_cross (const ScoTrigger *t, const float p, const float x,
+    const uint32_t i, const int zp, const int z)
+{
+  const float a = t->sgn * p;
+  const float b = t->sgn * x;
+  const float thr = z > zp ? (z == 2 ? t->hi : t->lo) : (z == 0 ? t->lo : t->hi);
+  if (a == b) {
+    return i;
+  }
+  const float f = (thr - a) / (b - a);
+  return i - 1.0 + (f < 0 ? 0 : (f > 1 ? 1 : f));
+}
+
+static int32_t
+sco_trigger_scan_block (ScoTrigger *t, const float *d, const uint32_t n, const uint32_t from)
+{
+  uint32_t i = 0;
+  int32_t rv = -1;
+
+  if (t->kind == TRIG_SLOPE) {
+    i = from < n ? from : n;
+    i += sco_find_slope (&d[i], n - i, i > 0 ? d[i - 1] : t->prev, t->sgn, t->slope);
+    if (i < n) {
+      rv = i;
+      t->cross = i;
+    }
+  } else {
+    for (; i < n; ++i) {
+      i += sco_find_zone_change (&d[i], n - i, i > 0 ? d[i - 1] : t->prev, t->sgn, t->lo, t->hi);
+      if (i >= n) {
+	break;
+      }
+      const int zp = t->zone;
+      const int z = sco_trigger_zone (t, d[i]);
+      bool fire = false;
+      switch (t->kind) {
+	case TRIG_EDGE:
+	  if (z == 0) {
+	    t->high = false;
+	  } else if (z == 2 && !t->high) {
+	    t->high = true;
+	    fire = true;
+	  }
+	  break;
+	case TRIG_PULSE_GT:
+	case TRIG_PULSE_LT:
+	  if (z == 2 && !t->high) {
+	    t->high = true;
+	    t->armed = true;
+	    t->start = t->pos + i;
+	  } else if (z == 0 && t->high) {
+	    t->high = false;
+	    if (t->armed) {
+	      const uint64_t w = t->pos + i - t->start;
+	      fire = t->kind == TRIG_PULSE_GT ? w > t->width : w < t->width;
+	    }
+	    t->armed = false;
+	  }
+	  break;
+	case TRIG_WINDOW_EXIT:
+	  fire = t->zone == 1 && z != 1;
+	  break;
+	case TRIG_WINDOW_ENTER:
+	  fire = t->zone != 1 && z == 1;
+	  break;
+	case TRIG_RUNT:
+	  if (t->zone == 0 && z == 1) {
+	    t->armed = true;
+	  } else if (z == 2) {
+	    t->armed = false;
+	  } else if (z == 0 && t->armed) {
+	    fire = true;
+	    t->armed = false;
+	  }
+	  break;
+      }
+      t->zone = z;
+      if (fire && i >= from) {
+	rv = i;
+	t->cross = sco_trigger_cross (t, i > 0 ? d[i - 1] : t->prev, d[i], i, zp, z);
+	break;
+      }
+    }
+  }
+
+  if (rv >= 0) {
+    t->prev = d[rv];
+    t->pos += rv + 1;
+  } else if (n > 0) {
+    t->prev = d[n - 1];
+    t->pos += n;
+  }
+  return rv;
+}
+
+/** look for the trigger in d[0 .. n), samples before 'from' only
+ * update the state. Returns the index of the trigger-sample and
+ * stops after it, or -1 when all n samples were consumed.
+ * t->cross is set to the interpolated position of the crossing,
+ * relative to d[0] and corrected for the delay of the low-pass.
+ */
+static int32_t
+sco_trigger_scan (ScoTrigger *t, const float *d, const uint32_t n, const uint32_t from)
+{
+  if (t->lpf <= 0) {
+    return sco_trigger_scan_block (t, d, n, from);
+  }
+
+  float buf[SCO_TRIGGER_CHUNK];
+  const float a = t->lpf;
+  for (uint32_t i = 0; i < n; i += SCO_TRIGGER_CHUNK) {
+    const uint32_t k = n - i < SCO_TRIGGER_CHUNK ? n - i : SCO_TRIGGER_CHUNK;
+    float z = t->lpz;
+    for (uint32_t j = 0; j < k; ++j) {
+      z += a * (d[i + j] - z) + 1e-20f;
+      buf[j] = z;
+    }
+    const int32_t rv = sco_trigger_scan_block (t, buf, k, from > i ? from - i : 0);
+    if (rv >= 0) {
+      t->lpz = buf[rv];
+      t->cross += i - t->delay;
+      return i + rv;
+    }
+    t->lpz = z;
+  }
+  return -1;
+}
+
+#endif
@@ -43,10 +43,16 @@ typedef struct {
 	LV2_URID atom_Vector;
 	LV2_URID atom_Float;
 	LV2_URID atom_Int;
+	LV2_URID atom_Long;
 	LV2_URID atom_eventTransfer;
 	LV2_URID rawaudio;
 	LV2_URID channelid;
 	LV2_URID audiodata;
+	LV2_URID decimated; // min/max/rms column triplets instead of rawaudio
+	LV2_URID trigger; // rawaudio starts a triggered window, value: pre-trigger samples, -1: DSP trigger gave up
+	LV2_URID sequence; // per channel message counter, to detect lost messages
+	LV2_URID samplepos; // sample-position of the first sample in the message
+	LV2_URID runtime; // duration of the previous run() [ns], sent while profiling
 
 	LV2_URID samplerate;
 	LV2_URID ui_on;
@@ -57,7 +63,11 @@ typedef struct {
 	LV2_URID ui_state_grid;
 	LV2_URID ui_state_trig;
 	LV2_URID ui_state_curs;
-	LV2_URID ui_state_misc; // bitwise bool, currently only amp-lock bit:1
+	LV2_URID ui_state_misc; // bit 0: amp-lock, bit 1: align, bits 2-4: display mode, bits 5-7: FFT size, bits 8-9: FFT averaging, bits 10-11: acquisition mode, bits 12-15: sweep averaging, bits 16-18: number of segments, bits 19-20: deep memory
+	LV2_URID ui_state_stride; // requested DSP-side decimation, 0: raw audio
+	LV2_URID ui_state_want; // bitmask of channels to send, bit 'n' for channel 'n'
+	LV2_URID ui_state_tarm; // arm DSP trigger: int vector [pre, post] samples, 0: disarm
+	LV2_URID ui_state_prof; // 1: measure run() and send the runtime, 0: off
 } ScoLV2URIs;
 
 static inline void
@@ -67,10 +77,16 @@ map_sco_uris(LV2_URID_Map* map, ScoLV2URIs* uris) {
 	uris->atom_Vector        = map->map(map->handle, LV2_ATOM__Vector);
 	uris->atom_Float         = map->map(map->handle, LV2_ATOM__Float);
 	uris->atom_Int           = map->map(map->handle, LV2_ATOM__Int);
+	uris->atom_Long          = map->map(map->handle, LV2_ATOM__Long);
 	uris->atom_eventTransfer = map->map(map->handle, LV2_ATOM__eventTransfer);
 	uris->rawaudio           = map->map(map->handle, SCO_URI "#rawaudio");
 	uris->audiodata          = map->map(map->handle, SCO_URI "#audiodata");
 	uris->channelid          = map->map(map->handle, SCO_URI "#channelid");
+	uris->decimated          = map->map(map->handle, SCO_URI "#decimated");
+	uris->trigger            = map->map(map->handle, SCO_URI "#trigger");
+	uris->sequence           = map->map(map->handle, SCO_URI "#sequence");
+	uris->samplepos          = map->map(map->handle, SCO_URI "#samplepos");
+	uris->runtime            = map->map(map->handle, SCO_URI "#runtime");
 	uris->samplerate         = map->map(map->handle, SCO_URI "#samplerate");
 	uris->ui_on              = map->map(map->handle, SCO_URI "#ui_on");
 	uris->ui_off             = map->map(map->handle, SCO_URI "#ui_off");
@@ -80,6 +96,10 @@ map_sco_uris(LV2_URID_Map* map, ScoLV2URIs* uris) {
 	uris->ui_state_trig      = map->map(map->handle, SCO_URI "#ui_state_trig");
 	uris->ui_state_curs      = map->map(map->handle, SCO_URI "#ui_state_curs");
 	uris->ui_state_misc      = map->map(map->handle, SCO_URI "#ui_state_misc");
+	uris->ui_state_stride    = map->map(map->handle, SCO_URI "#ui_state_stride");
+	uris->ui_state_want      = map->map(map->handle, SCO_URI "#ui_state_want");
+	uris->ui_state_tarm      = map->map(map->handle, SCO_URI "#ui_state_tarm");
+	uris->ui_state_prof      = map->map(map->handle, SCO_URI "#ui_state_prof");
 }
 
 struct triggerstate {
@@ -88,8 +108,15 @@ struct triggerstate {
 	float xpos;
 	float hold;
 	float level;
+	float kind;  // see trigger.h
+	float param; // pulse-width, slope, window or runt height
+	float hyst;  // hysteresis of edge and pulse triggers
+	float hfrej; // trigger low-pass cutoff [Hz], 0: off
 };
 
+/* states saved before 'kind' was added only have the first 5 members */
+#define TRIGGERSTATE_MIN_SIZE (5 * sizeof(float))
+
 struct channelstate {
 	float gain;
 	float xoff;
@@ -104,4 +131,10 @@ struct cursorstate {
 
 #define MAX_CHANNELS (4)
 
+/* DSP-side trigger: pre-trigger history per channel (power of two),
+ * 512KB per channel, allocated when the plugin is instantiated.
+ * The UI only arms the DSP trigger if pre-trigger <= half of it,
+ * the DSP refuses host cycles longer than half of it. */
+#define DSP_TRIGGER_BUFSZ (131072)
+
 #endif
@@ -0,0 +1,305 @@
+// ----------------------------------------------------------------------------
+//
+//  Copyright (C) 2006-2012 Fons Adriaensen <fons@linuxaudio.org>
+//  Copyright (C) 2013 Robin Gareus <robin@gareus.org>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+// ----------------------------------------------------------------------------
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../zita-resampler/interpolator.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#define INTERP_SSE
+#endif
+
+#if defined(INTERP_SSE) && defined(__GNUC__) && !defined(_WIN32)
+#include <immintrin.h>
+#define INTERP_AVX
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define INTERP_NEON
+#endif
+
+namespace LV2S {
+
+
+// For every input sample n:  out [n * ratio + j] = sum_k inp [n + k] * coef [k][j]
+
+static void interp_scalar (const float *inp, const float *coef,
+                           unsigned int n, unsigned int ntap,
+                           unsigned int nph, unsigned int ratio,
+                           float *out)
+{
+    float  acc [Interpolator::MAXRATIO];
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+	memset (acc, 0, nph * sizeof (float));
+	for (unsigned int k = 0; k < ntap; k++)
+	{
+	    const float x = inp [i + k];
+	    const float *c = coef + k * nph;
+	    for (unsigned int j = 0; j < ratio; j++) acc [j] += x * c [j];
+	}
+	memcpy (out, acc, ratio * sizeof (float));
+	out += ratio;
+    }
+}
+
+
+#ifdef INTERP_SSE
+static void interp_sse (const float *inp, const float *coef,
+                        unsigned int n, unsigned int ntap,
+                        unsigned int nph, unsigned int ratio,
+                        float *out)
+{
+    float  acc [Interpolator::MAXRATIO];
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+	for (unsigned int j = 0; j < nph; j += 8)
+	{
+	    __m128 a0 = _mm_setzero_ps ();
+	    __m128 a1 = _mm_setzero_ps ();
+	    const float *c = coef + j;
+	    for (unsigned int k = 0; k < ntap; k++, c += nph)
+	    {
+		const __m128 x = _mm_set1_ps (inp [i + k]);
+		a0 = _mm_add_ps (a0, _mm_mul_ps (x, _mm_loadu_ps (c)));
+		a1 = _mm_add_ps (a1, _mm_mul_ps (x, _mm_loadu_ps (c + 4)));
+	    }
+	    _mm_storeu_ps (acc + j, a0);
+	    _mm_storeu_ps (acc + j + 4, a1);
+	}
+	memcpy (out, acc, ratio * sizeof (float));
+	out += ratio;
+    }
+}
+#endif
+
+
+#ifdef INTERP_AVX
+__attribute__((target("avx")))
+static void interp_avx (const float *inp, const float *coef,
+                        unsigned int n, unsigned int ntap,
+                        unsigned int nph, unsigned int ratio,
+                        float *out)
+{
+    float  acc [Interpolator::MAXRATIO];
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+	for (unsigned int j = 0; j < nph; j += 8)
+	{
+	    __m256 a = _mm256_setzero_ps ();
+	    const float *c = coef + j;
+	    for (unsigned int k = 0; k < ntap; k++, c += nph)
+	    {
+		a = _mm256_add_ps (a, _mm256_mul_ps (_mm256_set1_ps (inp [i + k]), _mm256_loadu_ps (c)));
+	    }
+	    _mm256_storeu_ps (acc + j, a);
+	}
+	memcpy (out, acc, ratio * sizeof (float));
+	out += ratio;
+    }
+    _mm256_zeroupper ();
+}
+#endif
+
+
+#ifdef INTERP_NEON
+static void interp_neon (const float *inp, const float *coef,
+                         unsigned int n, unsigned int ntap,
+                         unsigned int nph, unsigned int ratio,
+                         float *out)
+{
+    float  acc [Interpolator::MAXRATIO];
+
+    for (unsigned int i = 0; i < n; i++)
+    {
+	for (unsigned int j = 0; j < nph; j += 8)
+	{
+	    float32x4_t a0 = vdupq_n_f32 (0);
+	    float32x4_t a1 = vdupq_n_f32 (0);
+	    const float *c = coef + j;
+	    for (unsigned int k = 0; k < ntap; k++, c += nph)
+	    {
+		const float32x4_t x = vdupq_n_f32 (inp [i + k]);
+		a0 = vmlaq_f32 (a0, x, vld1q_f32 (c));
+		a1 = vmlaq_f32 (a1, x, vld1q_f32 (c + 4));
+	    }
+	    vst1q_f32 (acc + j, a0);
+	    vst1q_f32 (acc + j + 4, a1);
+	}
+	memcpy (out, acc, ratio * sizeof (float));
+	out += ratio;
+    }
+}
+#endif
+
+
+static Interpolator::kernel_t select_kernel (void)
+{
+#ifdef INTERP_AVX
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx")) return interp_avx;
+#endif
+#if defined INTERP_SSE
+    return interp_sse;
+#elif defined INTERP_NEON
+    return interp_neon;
+#else
+    return interp_scalar;
+#endif
+}
+
+
+Interpolator::Interpolator (void) :
+    _table (0),
+    _ratio (0),
+    _ntap (0),
+    _nph (0),
+    _coef (0),
+    _buff (0),
+    _kern (0)
+{
+    reset ();
+}
+
+
+Interpolator::~Interpolator (void)
+{
+    clear ();
+}
+
+
+int Interpolator::setup (unsigned int ratio,
+                         unsigned int hlen,
+                         double       frel)
+{
+    unsigned int       h, j, k, p;
+    float              *C = 0;
+    float              *B = 0;
+    Resampler_table    *T = 0;
+
+    p = 0;
+    if ((ratio >= 1) && (ratio <= MAXRATIO) && (hlen >= 8) && (hlen <= 96))
+    {
+	h = hlen;
+	p = (ratio + 7) & ~7;
+	T = Resampler_table::create (frel, h, ratio);
+	C = new float [2 * h * p];
+	B = new float [2 * h - 1 + CHUNK];
+	memset (C, 0, 2 * h * p * sizeof (float));
+
+	// Resampler::process() applies row [ph] to the first,
+	// and row [np - ph] mirrored to the second half of the window.
+	for (j = 0; j < ratio; j++)
+	{
+	    const float *c1 = T->_ctab + h * j;
+	    const float *c2 = T->_ctab + h * (ratio - j);
+	    for (k = 0; k < h; k++)
+	    {
+		C [k * p + j] = c1 [k];
+		C [(2 * h - 1 - k) * p + j] = c2 [k];
+	    }
+	}
+    }
+    clear ();
+    if (T)
+    {
+	_table = T;
+	_ratio = ratio;
+	_ntap  = 2 * h;
+	_nph   = p;
+	_coef  = C;
+	_buff  = B;
+	_kern  = select_kernel ();
+	return reset ();
+    }
+    else return 1;
+}
+
+
+void Interpolator::clear (void)
+{
+    Resampler_table::destroy (_table);
+    delete[] _coef;
+    delete[] _buff;
+    _table = 0;
+    _coef  = 0;
+    _buff  = 0;
+    _ratio = 0;
+    _ntap  = 0;
+    _nph   = 0;
+    reset ();
+}
+
+
+int Interpolator::reset (void)
+{
+    inp_count = 0;
+    out_count = 0;
+    inp_data = 0;
+    out_data = 0;
+    if (!_table) return 1;
+    memset (_buff, 0, (_ntap - 1) * sizeof (float));
+    return 0;
+}
+
+
+int Interpolator::process (void)
+{
+    unsigned int   n, hist;
+
+    if (!_table) return 1;
+    hist = _ntap - 1;
+
+    while (inp_count && (out_count >= _ratio))
+    {
+	n = inp_count;
+	if (n > CHUNK) n = CHUNK;
+	if (n > out_count / _ratio) n = out_count / _ratio;
+
+	if (inp_data)
+	{
+	    memcpy (_buff + hist, inp_data, n * sizeof (float));
+	    inp_data += n;
+	}
+	else memset (_buff + hist, 0, n * sizeof (float));
+
+	if (out_data)
+	{
+	    _kern (_buff, _coef, n, _ntap, _nph, _ratio, out_data);
+	    out_data += n * _ratio;
+	}
+
+	memmove (_buff, _buff + n, hist * sizeof (float));
+	inp_count -= n;
+	out_count -= n * _ratio;
+    }
+    return 0;
+}
+
+
+}
@@ -1,7 +1,8 @@
 // ----------------------------------------------------------------------------
 //
 //  Copyright (C) 2006-2012 Fons Adriaensen <fons@linuxaudio.org>
-//    
+//  Copyright (C) 2013 Robin Gareus <robin@gareus.org>
+//
 //  This program is free software; you can redistribute it and/or modify
 //  it under the terms of the GNU General Public License as published by
 //  the Free Software Foundation; either version 3 of the License, or
@@ -18,8 +19,8 @@
 // ----------------------------------------------------------------------------
 
 
-#ifndef __RESAMPLER_H
-#define __RESAMPLER_H
+#ifndef __INTERPOLATOR_H
+#define __INTERPOLATOR_H
 
 
 #include "../zita-resampler/resampler-table.h"
@@ -27,51 +28,53 @@
 
 namespace LV2S {
 
-class Resampler
+// Upsampling by an integer ratio, single channel.
+//
+// Same filter as Resampler, but all output phases of an input
+// sample are computed at once: coefficients are stored by tap,
+// each tap contributes to all phases in one vector operation.
+//
+// process () reads inp_count samples, writes inp_count * ratio
+// samples and advances inp_data/out_data, like Resampler.
+
+class Interpolator
 {
 public:
 
-    Resampler (void);
-    ~Resampler (void);
+    Interpolator (void);
+    ~Interpolator (void);
 
-    int  setup (unsigned int fs_inp,
-                unsigned int fs_out,
-                unsigned int nchan,
-                unsigned int hlen);
-
-    int  setup (unsigned int fs_inp,
-                unsigned int fs_out,
-                unsigned int nchan,
+    int  setup (unsigned int ratio,
                 unsigned int hlen,
                 double       frel);
 
     void   clear (void);
     int    reset (void);
-    int    nchan (void) const { return _nchan; }
-    int    filtlen (void) const { return inpsize (); } // Deprecated
-    int    inpsize (void) const;
-    double inpdist (void) const; 
+    int    ratio (void) const { return _ratio; }
+    int    inpsize (void) const { return _ntap; }
     int    process (void);
 
     unsigned int         inp_count;
     unsigned int         out_count;
     const float         *inp_data;
     float               *out_data;
-    void                *inp_list;
-    void                *out_list;
+
+    enum { MAXRATIO = 64, CHUNK = 256 };
+
+    typedef void (*kernel_t) (const float *inp, const float *coef,
+                              unsigned int n, unsigned int ntap,
+                              unsigned int nph, unsigned int ratio,
+                              float *out);
 
 private:
 
     Resampler_table     *_table;
-    unsigned int         _nchan;
-    unsigned int         _inmax;
-    unsigned int         _index;
-    unsigned int         _nread;
-    unsigned int         _nzero;
-    unsigned int         _phase;
-    unsigned int         _pstep;
-    float               *_buff;
-    void                *_dummy [8];
+    unsigned int         _ratio;
+    unsigned int         _ntap;  // filter length, 2 * hlen
+    unsigned int         _nph;   // phases, padded to a multiple of 8
+    float               *_coef;  // [_ntap][_nph]
+    float               *_buff;  // history + CHUNK input samples
+    kernel_t             _kern;
 };
 
 };
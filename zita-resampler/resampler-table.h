@@ -55,6 +55,7 @@ private:
 
     friend class Resampler;
     friend class VResampler;
+    friend class Interpolator;
 
     Resampler_table     *_next;
     unsigned int         _refc;